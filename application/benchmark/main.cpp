@@ -0,0 +1,397 @@
+/*
+ * dynamic_library 热点路径微基准测试
+ *
+ * 用法: loader_benchmark [动态库路径] [迭代倍数]
+ *   - 动态库路径默认为 ./libdynamic.so (Windows 为 dynamic.dll), 即 dynamic/src/dynamic.cpp 编译出的动态库
+ *   - 迭代倍数默认为 1, 数值越大结果越稳定
+ *
+ * 测试项:
+ *   1. 直接调用 vs get<>() 函数指针 vs invoke()(缓存) vs invoke_uncached()
+ *   2. has_symbol() 命中 / 未命中
+ *   3. 首次 load/unload(单个样本) 与 load/unload 循环([refcount] 表示动态库没有真正卸载, 循环只是重新打开)
+ *   4. 1~64 线程并发 invoke() (cache_mode::locked、cache_mode::lock_free 与 cache_mode::thread_local_tier)
+ *   5. 逐元素调用 doubleAdd vs 批量接口 doubleAddN / transformPoints (SIMD), AoS vs SoA 布局
+ *   6. 本地 snprintf 基线 vs point2String / point2Chars (std::to_chars) vs 批量 points2Chars
+ *   7. 进程外执行(sandbox.hpp, 仅 POSIX): 单次 invoke() 往返 vs 批量 post()/flush(), 带输出缓冲区的调用
+ *   8. 大结构体按值传参 box2String(box_t, ...): get<>() 指针 vs invoke()(完美转发) vs 按值转发(多一次复制)
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dynamic_library/dynamic_library.hpp"
+#include "dynamic_library/sandbox.hpp"
+
+#if defined(_MSC_VER)
+#define BENCH_NOINLINE __declspec(noinline)
+#else
+#define BENCH_NOINLINE __attribute__((noinline))
+#endif
+
+namespace
+{
+using clock_type = std::chrono::steady_clock;
+
+volatile int g_sink = 0;  // 防止编译器把被测调用优化掉
+
+/// @brief 与动态库中 intAdd 等价的本地函数, 作为"直接调用"基线
+BENCH_NOINLINE int local_int_add(int a, int b)
+{
+  return a + b;
+}
+
+/// @brief 与动态库中 point_t 布局一致
+struct point_t
+{
+  double x;
+  double y;
+  double z;
+};
+
+/// @brief 与动态库中 box_t 布局一致(120 字节, 按值传递时整体复制)
+struct box_t
+{
+  int id;
+  char name[64];
+  point_t min;
+  point_t max;
+};
+
+/// @brief 与动态库中 point_soa_t 布局一致
+struct point_soa_t
+{
+  double *x;
+  double *y;
+  double *z;
+  std::size_t size;
+  std::size_t capacity;
+};
+
+/// @brief 与动态库中 format_result_t 布局一致
+struct format_result_t
+{
+  std::size_t length;
+  int truncated;
+};
+
+/// @brief 执行 iters 次 fn 并返回每次调用的平均耗时(纳秒), 正式计时前先预热
+template <typename Fn>
+double measure(std::size_t iters, Fn &&fn)
+{
+  for (std::size_t i = 0; i < iters / 10 + 1; ++i) fn(i);
+  auto begin = clock_type::now();
+  for (std::size_t i = 0; i < iters; ++i) fn(i);
+  auto end = clock_type::now();
+  return std::chrono::duration<double, std::nano>(end - begin).count() / static_cast<double>(iters);
+}
+
+/// @brief 开启导出表索引的加载选项
+dll::load_options indexed_options()
+{
+  dll::load_options options;
+  options.export_index = true;
+  return options;
+}
+
+void print_row(const std::string &name, double ns_per_op)
+{
+  std::printf("  %-44s %12.2f ns/op\n", name.c_str(), ns_per_op);
+}
+
+void print_header(const char *title)
+{
+  std::printf("\n[%s]\n", title);
+}
+
+/// @brief 测试 1: 各种调用方式的单次调用开销
+void bench_call_paths(const std::string &path, std::size_t scale)
+{
+  print_header("call paths");
+  const std::size_t iters = 10000000 * scale;
+  dll::dynamic_library lib(path);
+  auto fn = lib.get<int(int, int)>("intAdd");
+
+  print_row("direct call (local noinline)", measure(iters, [](std::size_t i) {
+              g_sink = local_int_add(static_cast<int>(i), 1);
+            }));
+  print_row("get<>() pointer", measure(iters, [fn](std::size_t i) { g_sink = fn(static_cast<int>(i), 1); }));
+  print_row("get<>() per call (cached lookup)", measure(iters, [&lib](std::size_t i) {
+              g_sink = lib.get<int(int, int)>("intAdd")(static_cast<int>(i), 1);
+            }));
+  print_row("invoke() (cached)", measure(iters, [&lib](std::size_t i) {
+              g_sink = lib.invoke<int(int, int)>("intAdd", static_cast<int>(i), 1);
+            }));
+  print_row("invoke_uncached()", measure(iters / 10, [&lib](std::size_t i) {
+              g_sink = lib.invoke_uncached<int(int, int)>("intAdd", static_cast<int>(i), 1);
+            }));
+
+  dll::dynamic_library indexed(path, indexed_options());
+  print_row("invoke_uncached() (export index)", measure(iters / 10, [&indexed](std::size_t i) {
+              g_sink = indexed.invoke_uncached<int(int, int)>("intAdd", static_cast<int>(i), 1);
+            }));
+}
+
+/// @brief 测试 2: has_symbol() 命中与未命中
+void bench_has_symbol(const std::string &path, std::size_t scale)
+{
+  print_header("has_symbol");
+  const std::size_t iters = 5000000 * scale;
+  dll::dynamic_library lib(path);
+  print_row("has_symbol() hit", measure(iters, [&lib](std::size_t) { g_sink = lib.has_symbol("intAdd"); }));
+  print_row("has_symbol() miss", measure(iters, [&lib](std::size_t) { g_sink = lib.has_symbol("notExistFunc"); }));
+  print_row("has_symbol() hit (std::string)", measure(iters, [&lib](std::size_t) {
+              static const std::string name = "doubleAdd";
+              g_sink = lib.has_symbol(name);
+            }));
+}
+
+/// @brief 动态库当前是否已在进程中(只查询, 不增加系统加载器的引用计数)
+bool is_resident(const std::string &path)
+{
+#if defined(_WIN32) || defined(_WIN64)
+  return dll::detail::GetModuleHandleW(dll::detail::widen_path(path).c_str()) != nullptr;
+#else
+  void *handle = dll::detail::dlopen(path.c_str(), RTLD_LAZY | RTLD_NOLOAD);
+  if (handle != nullptr) dll::detail::dlclose(handle);
+  return handle != nullptr;
+#endif
+}
+
+/// @brief 测试 3: load/unload 耗时
+void bench_load_unload(const std::string &path, std::size_t scale)
+{
+  print_header("load/unload");
+  const std::size_t iters = 200 * scale;
+  // 真正的首次加载(映射、重定位、运行构造函数)每个进程只有一次: 必须在其他测试加载该动态库之前执行
+  const auto begin = clock_type::now();
+  {
+    dll::dynamic_library lib(path);
+    lib.unload();
+  }
+  print_row("first load + unload (1 sample)",
+            std::chrono::duration<double, std::nano>(clock_type::now() - begin).count());
+
+  // 动态库含 STB_GNU_UNIQUE 符号(如 libstdc++ 的内联静态变量)时 glibc 不会真正卸载,
+  // 之后的循环只是按引用计数重新打开已映射的动态库, 行名以 [refcount] 标明
+  const char *kind = is_resident(path) ? " [refcount]" : " [full load]";
+  print_row(std::string("load + unload") + kind, measure(iters, [&path](std::size_t) {
+              dll::dynamic_library lib(path);
+              lib.unload();
+            }));
+  print_row(std::string("load + unload + export index") + kind, measure(iters, [&path](std::size_t) {
+              dll::dynamic_library lib(path, indexed_options());
+              lib.unload();
+            }));
+  dll::dynamic_library keep(path);  // 保持一个引用, 之后的 load 只增加系统加载器的引用计数
+  print_row("load + unload [refcount, handle kept]", measure(iters * 10, [&path](std::size_t) {
+              dll::dynamic_library lib(path);
+              lib.unload();
+            }));
+}
+
+/// @brief 测试 4: 多线程并发 invoke(), 输出总吞吐量和每次调用的平均耗时
+void bench_contended(const std::string &path, std::size_t scale, dll::cache_mode mode, const char *mode_name)
+{
+  std::printf("\n[contended invoke(), cache_mode::%s]\n", mode_name);
+  const std::size_t iters = 1000000 * scale;
+  dll::dynamic_library lib(path, mode);
+  const char *names[] = {"intAdd", "floatAdd", "doubleAdd"};
+  for (const char *name : names) lib.has_symbol(name);  // 预热缓存, 只测试命中路径
+
+  for (std::size_t threads = 1; threads <= 64; threads *= 2)
+  {
+    std::atomic<std::size_t> ready(0);
+    std::atomic<bool> go(false);
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (std::size_t t = 0; t < threads; ++t)
+    {
+      workers.emplace_back([&lib, &ready, &go, iters, t] {
+        ready.fetch_add(1);
+        while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+        int acc = 0;
+        for (std::size_t i = 0; i < iters; ++i) acc += lib.invoke<int(int, int)>("intAdd", static_cast<int>(i + t), 1);
+        g_sink = acc;
+      });
+    }
+    while (ready.load() != threads) std::this_thread::yield();
+    auto begin = clock_type::now();
+    go.store(true, std::memory_order_release);
+    for (auto &w : workers) w.join();
+    auto end = clock_type::now();
+
+    double total_ns = std::chrono::duration<double, std::nano>(end - begin).count();
+    double ops = static_cast<double>(iters * threads);
+    std::printf("  %2zu threads: %10.2f Mops/s  %10.2f ns/op per thread\n", threads, ops / total_ns * 1000.0,
+                total_ns / static_cast<double>(iters));
+  }
+}
+
+/// @brief 测试 5: 逐元素跨越动态库边界 vs 一次调用处理整个数组, 输出每个元素的平均耗时
+void bench_batch(const std::string &path, std::size_t scale)
+{
+  const std::size_t n = 4096;
+  const std::size_t rounds = 2000 * scale;
+  dll::dynamic_library lib(path);
+  std::printf("\n[batch vs per-element, n = %zu, simd = %s]\n", n, lib.invoke<const char *()>("simdLevel"));
+  std::vector<double> a(n, 1.5), b(n, 2.5), out(n);
+  std::vector<point_t> points(n, point_t{1, 2, 3});
+  const point_t offset = {1, 1, 1};
+
+  auto add = lib.get<double(double, double)>("doubleAdd");
+  auto add_n = lib.get<void(const double *, const double *, double *, std::size_t)>("doubleAddN");
+  auto transform = lib.get<void(const point_t *, point_t *, std::size_t, double, point_t)>("transformPoints");
+  const double per = static_cast<double>(n);
+  print_row("doubleAdd per element", measure(rounds, [&](std::size_t) {
+              for (std::size_t i = 0; i < n; ++i) out[i] = add(a[i], b[i]);
+            }) / per);
+  print_row("doubleAddN", measure(rounds, [&](std::size_t) { add_n(a.data(), b.data(), out.data(), n); }) / per);
+  print_row("transformPoints (in place)", measure(rounds, [&](std::size_t) {
+              transform(points.data(), points.data(), n, 1.0, offset);
+            }) / per);
+
+  point_soa_t soa;
+  if (lib.invoke<int(point_soa_t *, std::size_t)>("point_soa_init", &soa, n) != 0) return;
+  lib.invoke<std::size_t(point_soa_t *, const point_t *, std::size_t)>("point_soa_from_aos", &soa, points.data(), n);
+  auto transform_soa = lib.get<void(const point_soa_t *, point_soa_t *, double, point_t)>("transformPointsSoa");
+  print_row("transformPointsSoa (in place)", measure(rounds, [&](std::size_t) {
+              transform_soa(&soa, &soa, 1.0, offset);
+            }) / per);
+  g_sink = static_cast<int>(out[n - 1] + points[0].x + soa.x[0]);
+  lib.invoke<void(point_soa_t *)>("point_soa_free", &soa);
+}
+
+/// @brief 测试 6: 格式化 point_t, 输出每个点的平均耗时
+void bench_format(const std::string &path, std::size_t scale)
+{
+  print_header("format points");
+  const std::size_t n = 1024;
+  const std::size_t rounds = 200 * scale;
+  dll::dynamic_library lib(path);
+  std::vector<point_t> points(n);
+  for (std::size_t i = 0; i < n; ++i) points[i] = point_t{i * 1.25, -(i * 0.5), 1e6 / (i + 1)};
+  std::vector<char> buf(n * 128);
+
+  auto to_string = lib.get<void(point_t *, char *, unsigned int)>("point2String");
+  auto to_chars = lib.get<format_result_t(const point_t *, char *, std::size_t)>("point2Chars");
+  using bulk_format = format_result_t(const point_t *, std::size_t, char *, std::size_t, std::size_t *);
+  auto bulk = lib.get<bulk_format>("points2Chars");
+  const double per = static_cast<double>(n);
+  print_row("snprintf (local baseline)", measure(rounds, [&](std::size_t) {
+              for (const auto &p : points)
+              {
+                std::snprintf(buf.data(), 128, "point_t { x=%.3f, y=%.3f, z=%.3f }", p.x, p.y, p.z);
+              }
+            }) / per);
+  print_row("point2String", measure(rounds, [&](std::size_t) {
+              for (std::size_t i = 0; i < n; ++i) to_string(&points[i], buf.data(), 128);
+            }) / per);
+  print_row("point2Chars (to_chars)", measure(rounds, [&](std::size_t) {
+              for (std::size_t i = 0; i < n; ++i) to_chars(&points[i], buf.data(), 128);
+            }) / per);
+  print_row("points2Chars (one buffer)", measure(rounds, [&](std::size_t) {
+              g_sink = static_cast<int>(bulk(points.data(), n, buf.data(), buf.size(), nullptr).length);
+            }) / per);
+}
+
+/// @brief 参数按值接收再转发的调用方式(invoke() 改为完美转发之前的实现), 每个按值参数多复制一次
+template <typename F, typename... Args>
+BENCH_NOINLINE void by_value_invoke(const dll::dynamic_library &lib, const char *name, Args... args)
+{
+  lib.get<F>(name)(std::forward<Args>(args)...);
+}
+
+/// @brief 测试 8: 大结构体按值传参, buf 为 nullptr 时 box2String 立即返回, 只剩参数传递的开销
+void bench_large_args(const std::string &path, std::size_t scale)
+{
+  print_header("large struct arguments (box2String(box_t, ...))");
+  const std::size_t iters = 10000000 * scale;
+  using box2string = void(box_t, char *, unsigned int);
+  dll::dynamic_library lib(path, dll::cache_mode::thread_local_tier);  // 查找开销最小, 突出参数复制的差异
+  auto fn = lib.get<box2string>("box2String");
+  box_t box = lib.invoke<box_t()>("getBox");
+  print_row("get<>() pointer", measure(iters, [&](std::size_t) { fn(box, nullptr, 0); }));
+  print_row("invoke() (perfect forwarding)", measure(iters, [&](std::size_t) {
+              lib.invoke<box2string>("box2String", box, nullptr, 0);
+            }));
+  print_row("invoke by value (extra copy)", measure(iters, [&](std::size_t) {
+              by_value_invoke<box2string>(lib, "box2String", box, nullptr, 0);
+            }));
+  char buf[256];
+  print_row("invoke() (formatting)", measure(iters / 10, [&](std::size_t) {
+              lib.invoke<box2string>("box2String", box, buf, sizeof(buf));
+            }));
+}
+
+#ifdef DLL_HAS_SANDBOX
+/// @brief 测试 7: 进程外调用, 输出每次调用的平均耗时(含跨进程唤醒)
+void bench_sandbox(const std::string &path, std::size_t scale)
+{
+  print_header("sandboxed calls (out of process)");
+  const std::size_t iters = 20000 * scale;
+  const std::size_t batch = 64;
+  dll::sandboxed_library sb(path);
+  print_row("invoke() (one round trip per call)", measure(iters, [&sb](std::size_t i) {
+              g_sink = sb.invoke<int(int, int)>("intAdd", static_cast<int>(i), 1);
+            }));
+  int results[batch];
+  print_row("post() x 64 + flush()", measure(iters / batch, [&](std::size_t i) {
+              for (std::size_t k = 0; k < batch; ++k)
+              {
+                sb.post<int(int, int)>(&results[k], "intAdd", static_cast<int>(i), static_cast<int>(k));
+              }
+              sb.flush();
+              g_sink = results[batch - 1];
+            }) / static_cast<double>(batch));
+  point_t p{1.0, 2.0, 3.0};
+  char buf[128];
+  using to_chars = format_result_t(const point_t *, char *, std::size_t);
+  print_row("point2Chars (in_buffer + out_buffer)", measure(iters, [&](std::size_t) {
+              format_result_t r = sb.invoke<to_chars>("point2Chars", dll::in_buffer(&p, 1),
+                                                      dll::out_buffer(buf, sizeof(buf)), sizeof(buf));
+              g_sink = static_cast<int>(r.length);
+            }));
+}
+#endif
+}  // namespace
+
+int main(int argc, char *argv[])
+{
+  const std::string path = argc > 1 ? argv[1] :
+#if defined(_WIN32) || defined(_WIN64)
+                                    "dynamic.dll";
+#else
+                                    "./libdynamic.so";
+#endif
+  const std::size_t scale = argc > 2 ? std::max(1, std::atoi(argv[2])) : 1;
+
+  try
+  {
+    std::printf("dynamic_library benchmark: %s (scale = %zu, hardware threads = %u)\n", path.c_str(), scale,
+                std::thread::hardware_concurrency());
+    bench_load_unload(path, scale);  // 最先执行, 保证第一项测试时动态库尚未被映射
+    bench_call_paths(path, scale);
+    bench_has_symbol(path, scale);
+    bench_contended(path, scale, dll::cache_mode::locked, "locked");
+    bench_contended(path, scale, dll::cache_mode::lock_free, "lock_free");
+    bench_contended(path, scale, dll::cache_mode::thread_local_tier, "thread_local_tier");
+    bench_batch(path, scale);
+    bench_format(path, scale);
+    bench_large_args(path, scale);
+#ifdef DLL_HAS_SANDBOX
+    bench_sandbox(path, scale);
+#endif
+  }
+  catch (const std::exception &e)
+  {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
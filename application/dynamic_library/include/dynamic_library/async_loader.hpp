@@ -0,0 +1,237 @@
+/*********************************************************************************************************
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * @file: async_loader.hpp
+ * @description: Asynchronous / parallel loading for dll::dynamic_library
+ *    - `dll::load_async()` loads one library on a background thread and returns a `std::future`.
+ *    - `dll::load_all()` loads a list of libraries concurrently and reports a result per library.
+ *    - `dll::thread_pool` is a small fixed-size pool shared by the loader helpers.
+ *
+ * Notes:
+ *    - dlopen/LoadLibrary are thread-safe but serialize on the system loader lock (mapping, relocation and
+ *      static initializers). The parallel part that actually overlaps is the disk I/O: each task first
+ *      prefetches the file into the page cache (outside the loader lock), then calls the loader.
+ *
+ * @license: MIT
+ * @repository: https://github.com/abin-z/DynamicLibLoader
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *********************************************************************************************************/
+
+#pragma once
+#ifndef DYNAMIC_LIBRARY_ASYNC_LOADER_H
+#define DYNAMIC_LIBRARY_ASYNC_LOADER_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "dynamic_library.hpp"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace dll
+{
+/// @brief 固定大小的线程池, 任务按提交顺序执行; 析构时执行完已提交的任务再退出
+class thread_pool
+{
+ public:
+  /// @param threads 线程数量, 0 表示使用 std::thread::hardware_concurrency()
+  /// @throw std::system_error 一个线程都无法创建时抛出异常; 部分线程创建失败时以已创建的线程运行(见 size())
+  explicit thread_pool(std::size_t threads = 0)
+  {
+    if (threads == 0) threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    workers_.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i)
+    {
+      try
+      {
+        workers_.emplace_back([this] { run(); });
+      }
+      catch (...)
+      {
+        if (workers_.empty()) throw;  // 没有需要 join 的线程, vector 析构是安全的
+        break;                        // 已创建的线程仍然可用, 不能在它们 joinable 时展开 workers_
+      }
+    }
+  }
+
+  ~thread_pool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto &t : workers_) t.join();
+  }
+
+  thread_pool(const thread_pool &) = delete;
+  thread_pool &operator=(const thread_pool &) = delete;
+
+  /// @brief 提交任务(不关心结果)
+  void post(std::function<void()> task)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      tasks_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+  }
+
+  /// @brief 提交任务并通过 std::future 获取结果或异常
+  template <typename Fn>
+  auto submit(Fn &&fn) -> std::future<decltype(fn())>
+  {
+    using result_type = decltype(fn());
+    auto task = std::make_shared<std::packaged_task<result_type()>>(std::forward<Fn>(fn));
+    std::future<result_type> fut = task->get_future();
+    post([task] { (*task)(); });
+    return fut;
+  }
+
+  /// @brief 线程数量
+  std::size_t size() const noexcept
+  {
+    return workers_.size();
+  }
+
+ private:
+  void run()
+  {
+    for (;;)
+    {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mtx_);
+        cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+        if (tasks_.empty()) return;  // stop_ 且任务已执行完
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      task();
+    }
+  }
+
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()>> tasks_;
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  bool stop_{false};
+};
+
+/// @brief 单个动态库的加载结果
+struct load_result
+{
+  std::string path;              // 动态库路径
+  dynamic_library library;       // 加载成功时有效
+  std::string error;             // 加载失败时的错误信息
+  std::exception_ptr exception;  // 加载失败时的原始异常
+
+  /// @brief 是否加载成功
+  bool ok() const noexcept
+  {
+    return !exception && library.valid();
+  }
+};
+
+namespace detail
+{
+/// @brief 预读动态库文件到页缓存: 这一步在系统加载器锁之外执行, 可以真正并行
+inline void prefetch_file(const std::string &path) noexcept
+{
+#if defined(__linux__)
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return;  // 不带路径的库名交给加载器搜索, 不预读
+  ::posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+  ::close(fd);
+#else
+  (void)path;
+#endif
+}
+
+/// @brief 后台加载使用的选项: 忽略 lazy, 否则返回尚未打开的动态库, load_result::ok() 为 false 且没有错误信息
+inline load_options eager_options(load_options options)
+{
+  options.lazy = false;
+  return options;
+}
+
+/// @brief 加载单个动态库, 把异常转换为 load_result(options 需已由 eager_options() 处理)
+inline load_result load_one(const std::string &path, const load_options &options)
+{
+  load_result result;
+  result.path = path;
+  try
+  {
+    prefetch_file(path);
+    result.library = dynamic_library(path, options);
+  }
+  catch (const std::exception &e)
+  {
+    result.error = e.what();
+    result.exception = std::current_exception();
+  }
+  catch (...)
+  {
+    result.error = "[dynamic_library] error: Unknown error while loading '" + path + "'";
+    result.exception = std::current_exception();
+  }
+  return result;
+}
+}  // namespace detail
+
+/**
+ * @brief 在后台线程加载动态库
+ * @param path 动态库路径
+ * @param options 加载选项(lazy 被忽略)
+ * @return 动态库对象的 future, 加载失败时 get() 抛出 std::runtime_error
+ */
+inline std::future<dynamic_library> load_async(const std::string &path, const load_options &options = load_options())
+{
+  const load_options eager = detail::eager_options(options);
+  return std::async(std::launch::async, [path, eager] {
+    detail::prefetch_file(path);
+    return dynamic_library(path, eager);
+  });
+}
+
+/**
+ * @brief 在线程池上并发加载多个动态库, 每个动态库单独报告成功或失败(不会因为某个库失败而抛出异常)
+ * @param paths 动态库路径列表
+ * @param options 加载选项(所有库共用, lazy 被忽略)
+ * @param max_threads 最大并发数, 0 表示 min(库数量, 硬件线程数)
+ * @return 与 paths 顺序一致的加载结果
+ */
+inline std::vector<load_result> load_all(const std::vector<std::string> &paths,
+                                         const load_options &options = load_options(), std::size_t max_threads = 0)
+{
+  std::vector<load_result> results;
+  if (paths.empty()) return results;
+  if (max_threads == 0) max_threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+  const load_options eager = detail::eager_options(options);
+  thread_pool pool(std::min(max_threads, paths.size()));
+  std::vector<std::future<load_result>> futures;
+  futures.reserve(paths.size());
+  for (const auto &path : paths)
+  {
+    futures.push_back(pool.submit([&path, &eager] { return detail::load_one(path, eager); }));
+  }
+  results.reserve(paths.size());
+  for (auto &f : futures) results.push_back(f.get());
+  return results;
+}
+
+}  // namespace dll
+
+#endif  // DYNAMIC_LIBRARY_ASYNC_LOADER_H
@@ -0,0 +1,166 @@
+/*********************************************************************************************************
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * @file: awaitable.hpp
+ * @description: C++20 coroutine awaitables for long-running plugin calls
+ *    - `co_await dll::async_call(executor, fn, args...)` runs a bound symbol (`dynamic_library::bind<F>()`)
+ *      on an executor and resumes the awaiting coroutine when the call has finished.
+ *    - `dll::async_call(executor, resume_on, fn, args...)` resumes on a second executor instead (for example
+ *      the reactor that owns the connection), so the coroutine never continues on a worker thread.
+ *    - An executor is any object with `post(callable)`, e.g. `dll::thread_pool` from async_loader.hpp.
+ *
+ * Notes:
+ *    - Only available when compiled as C++20 with <coroutine> (`DLL_HAS_COROUTINES` is then defined);
+ *      in C++11/14/17 builds this header is empty and the rest of the library is unaffected.
+ *    - Arguments are copied into the awaitable (pass pointers for caller buffers); the library must stay
+ *      loaded until the call completes. Exceptions (including an expired bound symbol) are rethrown
+ *      from `co_await`.
+ *
+ * @license: MIT
+ * @repository: https://github.com/abin-z/DynamicLibLoader
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *********************************************************************************************************/
+
+#pragma once
+#ifndef DYNAMIC_LIBRARY_AWAITABLE_H
+#define DYNAMIC_LIBRARY_AWAITABLE_H
+
+#include "dynamic_library.hpp"
+
+#if defined(_MSVC_LANG)
+#define DLL_CPLUSPLUS_ _MSVC_LANG
+#else
+#define DLL_CPLUSPLUS_ __cplusplus
+#endif
+
+#if DLL_CPLUSPLUS_ >= 202002L && defined(__has_include)
+#if __has_include(<coroutine>)
+#define DLL_HAS_COROUTINES 1
+#endif
+#endif
+#undef DLL_CPLUSPLUS_
+
+#ifdef DLL_HAS_COROUTINES
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace dll
+{
+/// @brief 在调用完成的线程上直接恢复协程(async_call 的默认恢复方式)
+struct resume_inline
+{
+  template <typename Fn>
+  void post(Fn &&fn) const
+  {
+    std::forward<Fn>(fn)();
+  }
+};
+
+/**
+ * @brief 在执行器上调用绑定符号的 awaitable, 由 async_call() 创建
+ *
+ * @tparam Executor 执行调用的执行器类型(需要 post(callable))
+ * @tparam Resume 恢复协程的执行器类型(需要 post(callable))
+ * @tparam F 函数类型
+ * @tparam Args 参数类型(按值保存)
+ */
+template <typename Executor, typename Resume, typename F, typename... Args>
+class plugin_call
+{
+  using result_type = decltype(std::declval<const bound_symbol<F> &>()(std::declval<Args &>()...));
+  using stored_type = std::conditional_t<std::is_void_v<result_type>, std::monostate, result_type>;
+
+ public:
+  plugin_call(Executor &executor, Resume &resume, bound_symbol<F> fn, Args... args) :
+    executor_(executor), resume_(resume), fn_(std::move(fn)), args_(std::move(args)...)
+  {
+  }
+
+  bool await_ready() const noexcept
+  {
+    return false;
+  }
+
+  /// @brief 把调用提交到执行器, 完成后通过 resume 执行器恢复协程
+  void await_suspend(std::coroutine_handle<> caller)
+  {
+    executor_.post([this, caller] {
+      try
+      {
+        if constexpr (std::is_void_v<result_type>)
+        {
+          std::apply(fn_, args_);
+          result_.emplace();
+        }
+        else
+        {
+          result_.emplace(std::apply(fn_, args_));
+        }
+      }
+      catch (...)
+      {
+        error_ = std::current_exception();
+      }
+      resume_.post([caller] { caller.resume(); });
+    });
+  }
+
+  /// @brief 返回调用结果, 调用抛出的异常在这里重新抛出
+  result_type await_resume()
+  {
+    if (error_) std::rethrow_exception(error_);
+    if constexpr (!std::is_void_v<result_type>) return std::move(*result_);
+  }
+
+ private:
+  Executor &executor_;                 // 执行调用的执行器
+  Resume &resume_;                     // 恢复协程的执行器
+  bound_symbol<F> fn_;                 // 绑定的函数符号
+  std::tuple<Args...> args_;           // 参数(按值保存, 直到调用完成)
+  std::optional<stored_type> result_;  // 调用结果
+  std::exception_ptr error_;           // 调用抛出的异常
+};
+
+/**
+ * @brief 在执行器上异步调用绑定符号, 调用完成后在执行调用的线程上恢复协程
+ *
+ *   dll::thread_pool pool(4);
+ *   auto render = lib.bind<int(const char *)>("render");
+ *   int rc = co_await dll::async_call(pool, render, "scene.json");
+ *
+ * @param executor 执行器, 必须在 co_await 结束之前保持有效
+ * @param fn 绑定的函数符号
+ * @param args 调用参数(复制到 awaitable 中)
+ */
+template <typename Executor, typename F, typename... Args>
+auto async_call(Executor &executor, const bound_symbol<F> &fn, Args &&...args)
+{
+  static resume_inline inline_resume;
+  return plugin_call<Executor, resume_inline, F, std::decay_t<Args>...>(executor, inline_resume, fn,
+                                                                        std::forward<Args>(args)...);
+}
+
+/**
+ * @brief 在执行器上异步调用绑定符号, 调用完成后通过 resume_on 恢复协程(如回到所属的 reactor 线程)
+ *
+ * @param executor 执行调用的执行器
+ * @param resume_on 恢复协程的执行器, 必须在 co_await 结束之前保持有效
+ * @param fn 绑定的函数符号
+ * @param args 调用参数(复制到 awaitable 中)
+ */
+template <typename Executor, typename Resume, typename F, typename... Args>
+auto async_call(Executor &executor, Resume &resume_on, const bound_symbol<F> &fn, Args &&...args)
+{
+  return plugin_call<Executor, Resume, F, std::decay_t<Args>...>(executor, resume_on, fn, std::forward<Args>(args)...);
+}
+
+}  // namespace dll
+
+#endif  // DLL_HAS_COROUTINES
+
+#endif  // DYNAMIC_LIBRARY_AWAITABLE_H
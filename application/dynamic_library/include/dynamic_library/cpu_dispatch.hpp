@@ -0,0 +1,347 @@
+/*********************************************************************************************************
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * @file: cpu_dispatch.hpp
+ * @description: Runtime CPU dispatch for dll::dynamic_library
+ *    - `dll::host_cpu_features()` probes CPUID/XGETBV (x86) or HWCAP (aarch64 Linux) once per process.
+ *    - `dll::load_best_variant()` takes several builds of the same library tagged with the CPU features
+ *      they require (baseline / AVX2 / AVX-512 ...) and loads the most specialized one the host can run.
+ *    - `dll::bind_best<F>()` does the same per symbol inside one library (ifunc-style), e.g.
+ *      `transform_avx512` / `transform_avx2` / `transform`.
+ *
+ * Notes:
+ *    - AVX/AVX-512 features are only reported when the OS also saves the wider register state (XCR0).
+ *    - Candidates are ranked by the number of required features (more = more specialized = preferred);
+ *      candidates with equal rank keep the caller's order.
+ *
+ * @license: MIT
+ * @repository: https://github.com/abin-z/DynamicLibLoader
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *********************************************************************************************************/
+
+#pragma once
+#ifndef DYNAMIC_LIBRARY_CPU_DISPATCH_H
+#define DYNAMIC_LIBRARY_CPU_DISPATCH_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "dynamic_library.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define DYNAMIC_LIBRARY_CPU_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define DYNAMIC_LIBRARY_CPU_ARM64
+#if defined(__linux__)
+#include <sys/auxv.h>
+#endif
+#endif
+
+namespace dll
+{
+/// @brief CPU 特性位集合, 由 cpu_feature 中的常量按位或组合
+using cpu_feature_set = std::uint32_t;
+
+/// @brief CPU 特性常量
+namespace cpu_feature
+{
+constexpr cpu_feature_set none = 0;
+// x86
+constexpr cpu_feature_set sse2 = 1u << 0;
+constexpr cpu_feature_set sse3 = 1u << 1;
+constexpr cpu_feature_set ssse3 = 1u << 2;
+constexpr cpu_feature_set sse4_1 = 1u << 3;
+constexpr cpu_feature_set sse4_2 = 1u << 4;
+constexpr cpu_feature_set popcnt = 1u << 5;
+constexpr cpu_feature_set avx = 1u << 6;
+constexpr cpu_feature_set avx2 = 1u << 7;
+constexpr cpu_feature_set fma = 1u << 8;
+constexpr cpu_feature_set f16c = 1u << 9;
+constexpr cpu_feature_set bmi1 = 1u << 10;
+constexpr cpu_feature_set bmi2 = 1u << 11;
+constexpr cpu_feature_set lzcnt = 1u << 12;
+constexpr cpu_feature_set movbe = 1u << 13;
+constexpr cpu_feature_set avx512f = 1u << 14;
+constexpr cpu_feature_set avx512cd = 1u << 15;
+constexpr cpu_feature_set avx512dq = 1u << 16;
+constexpr cpu_feature_set avx512bw = 1u << 17;
+constexpr cpu_feature_set avx512vl = 1u << 18;
+// aarch64
+constexpr cpu_feature_set neon = 1u << 24;
+constexpr cpu_feature_set sve = 1u << 25;
+constexpr cpu_feature_set sve2 = 1u << 26;
+
+// x86-64 微架构级别(与 GCC/Clang 的 -march=x86-64-v2/v3/v4 对应)
+constexpr cpu_feature_set x86_64_v2 = sse2 | sse3 | ssse3 | sse4_1 | sse4_2 | popcnt;
+constexpr cpu_feature_set x86_64_v3 = x86_64_v2 | avx | avx2 | fma | f16c | bmi1 | bmi2 | lzcnt | movbe;
+constexpr cpu_feature_set x86_64_v4 = x86_64_v3 | avx512f | avx512cd | avx512dq | avx512bw | avx512vl;
+}  // namespace cpu_feature
+
+namespace detail
+{
+#if defined(DYNAMIC_LIBRARY_CPU_X86)
+/// @brief 执行 CPUID(leaf, subleaf), 不支持的 leaf 返回全 0
+inline void cpuid(std::uint32_t leaf, std::uint32_t subleaf, std::uint32_t regs[4]) noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuidex(info, static_cast<int>(leaf), static_cast<int>(subleaf));
+  for (int i = 0; i < 4; ++i) regs[i] = static_cast<std::uint32_t>(info[i]);
+#else
+  unsigned int a = 0, b = 0, c = 0, d = 0;
+  if (!__get_cpuid_count(leaf, subleaf, &a, &b, &c, &d)) a = b = c = d = 0;
+  regs[0] = a;
+  regs[1] = b;
+  regs[2] = c;
+  regs[3] = d;
+#endif
+}
+
+/// @brief 读取 XCR0: 操作系统在线程切换时保存的寄存器状态
+inline std::uint64_t xgetbv0() noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+  return _xgetbv(0);
+#else
+  std::uint32_t lo = 0, hi = 0;
+  __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));  // 不依赖 -mxsave
+  return (static_cast<std::uint64_t>(hi) << 32) | lo;
+#endif
+}
+
+inline cpu_feature_set probe_cpu_features() noexcept
+{
+  using namespace cpu_feature;
+  std::uint32_t r[4];  // eax, ebx, ecx, edx
+  cpuid(0, 0, r);
+  const std::uint32_t max_leaf = r[0];
+  if (max_leaf < 1) return none;
+
+  cpuid(1, 0, r);
+  const std::uint32_t ecx1 = r[2], edx1 = r[3];
+  cpu_feature_set f = none;
+  if (edx1 & (1u << 26)) f |= sse2;
+  if (ecx1 & (1u << 0)) f |= sse3;
+  if (ecx1 & (1u << 9)) f |= ssse3;
+  if (ecx1 & (1u << 19)) f |= sse4_1;
+  if (ecx1 & (1u << 20)) f |= sse4_2;
+  if (ecx1 & (1u << 22)) f |= movbe;
+  if (ecx1 & (1u << 23)) f |= popcnt;
+
+  // AVX 系列需要操作系统保存 XMM/YMM 状态(XCR0 bit 1, 2), AVX-512 还需要 opmask/ZMM 状态(bit 5, 6, 7)
+  const bool osxsave = (ecx1 & (1u << 27)) != 0;
+  const std::uint64_t xcr0 = osxsave ? xgetbv0() : 0;
+  const bool os_avx = (xcr0 & 0x6) == 0x6;
+  const bool os_avx512 = (xcr0 & 0xe6) == 0xe6;
+  if (os_avx)
+  {
+    if (ecx1 & (1u << 28)) f |= avx;
+    if (ecx1 & (1u << 12)) f |= fma;
+    if (ecx1 & (1u << 29)) f |= f16c;
+  }
+
+  if (max_leaf >= 7)
+  {
+    cpuid(7, 0, r);
+    const std::uint32_t ebx7 = r[1];
+    if (ebx7 & (1u << 3)) f |= bmi1;
+    if (ebx7 & (1u << 8)) f |= bmi2;
+    if (os_avx && (ebx7 & (1u << 5))) f |= avx2;
+    if (os_avx512)
+    {
+      if (ebx7 & (1u << 16)) f |= avx512f;
+      if (ebx7 & (1u << 17)) f |= avx512dq;
+      if (ebx7 & (1u << 28)) f |= avx512cd;
+      if (ebx7 & (1u << 30)) f |= avx512bw;
+      if (ebx7 & (1u << 31)) f |= avx512vl;
+    }
+  }
+
+  cpuid(0x80000000u, 0, r);
+  if (r[0] >= 0x80000001u)
+  {
+    cpuid(0x80000001u, 0, r);
+    if (r[2] & (1u << 5)) f |= lzcnt;  // ABM
+  }
+  return f;
+}
+#elif defined(DYNAMIC_LIBRARY_CPU_ARM64)
+inline cpu_feature_set probe_cpu_features() noexcept
+{
+  cpu_feature_set f = cpu_feature::neon;  // AdvSIMD 是 aarch64 的基线
+#if defined(__linux__)
+  const unsigned long hwcap = getauxval(AT_HWCAP);
+  const unsigned long hwcap2 = getauxval(AT_HWCAP2);
+  if (hwcap & (1ul << 22)) f |= cpu_feature::sve;   // HWCAP_SVE
+  if (hwcap2 & (1ul << 1)) f |= cpu_feature::sve2;  // HWCAP2_SVE2
+#endif
+  return f;
+}
+#else
+inline cpu_feature_set probe_cpu_features() noexcept
+{
+  return cpu_feature::none;
+}
+#endif
+
+/// @brief 候选项的优先级: 要求的特性越多越优先
+inline int feature_rank(cpu_feature_set required) noexcept
+{
+  int n = 0;
+  for (; required; required &= required - 1) ++n;
+  return n;
+}
+
+/// @brief 按优先级(稳定)排序候选项下标, 只保留 host 能运行的候选项
+template <typename Candidate>
+std::vector<std::size_t> rank_candidates(const Candidate *candidates, std::size_t count, cpu_feature_set host)
+{
+  std::vector<std::size_t> order;
+  order.reserve(count);
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    if ((candidates[i].required & ~host) == 0) order.push_back(i);
+  }
+  std::stable_sort(order.begin(), order.end(), [candidates](std::size_t a, std::size_t b) {
+    return feature_rank(candidates[a].required) > feature_rank(candidates[b].required);
+  });
+  return order;
+}
+}  // namespace detail
+
+/// @brief 当前 CPU(及操作系统)支持的特性, 首次调用时检测一次
+inline cpu_feature_set host_cpu_features() noexcept
+{
+  static const cpu_feature_set features = detail::probe_cpu_features();
+  return features;
+}
+
+/// @brief 特性集合的可读名称, 如 "sse2 avx avx2 fma", 用于日志
+inline std::string cpu_feature_names(cpu_feature_set features)
+{
+  static const char *const names[] = {"sse2",    "sse3",     "ssse3",    "sse4.1",   "sse4.2",   "popcnt", "avx",
+                                      "avx2",    "fma",      "f16c",     "bmi1",     "bmi2",     "lzcnt",  "movbe",
+                                      "avx512f", "avx512cd", "avx512dq", "avx512bw", "avx512vl", nullptr,  nullptr,
+                                      nullptr,   nullptr,    nullptr,    "neon",     "sve",      "sve2"};
+  std::string out;
+  for (std::size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+  {
+    if (!names[i] || !(features & (1u << i))) continue;
+    if (!out.empty()) out += ' ';
+    out += names[i];
+  }
+  return out;
+}
+
+/// @brief 动态库的一个构建版本及其要求的 CPU 特性
+struct cpu_variant
+{
+  std::string path;          // 动态库路径
+  cpu_feature_set required;  // 运行该版本需要的特性, cpu_feature::none 表示基线版本
+};
+
+/**
+ * @brief 选择 host 能运行的最优候选项(不加载)
+ * @param candidates 候选列表
+ * @param host CPU 特性, 默认为当前 CPU
+ * @return 候选项下标, 没有可运行的候选项时返回 candidates.size()
+ */
+inline std::size_t select_variant(const std::vector<cpu_variant> &candidates,
+                                  cpu_feature_set host = host_cpu_features())
+{
+  auto order = detail::rank_candidates(candidates.data(), candidates.size(), host);
+  return order.empty() ? candidates.size() : order.front();
+}
+
+/**
+ * @brief 加载 host 能运行的最优版本; 最优版本加载失败(如文件不存在)时依次尝试下一个可运行的版本
+ *
+ *   auto lib = dll::load_best_variant({{"./libdynamic_avx512.so", dll::cpu_feature::x86_64_v4},
+ *                                      {"./libdynamic_avx2.so", dll::cpu_feature::x86_64_v3},
+ *                                      {"./libdynamic.so", dll::cpu_feature::none}});
+ *   std::cout << lib.path();  // 实际加载的版本
+ *
+ * @param candidates 候选列表
+ * @param options 加载选项
+ * @param host CPU 特性, 默认为当前 CPU
+ * @return 已加载的动态库
+ * @throw std::runtime_error 没有可运行的候选项, 或所有可运行的候选项都加载失败(异常信息包含每个候选项的错误)
+ */
+inline dynamic_library load_best_variant(const std::vector<cpu_variant> &candidates,
+                                         const load_options &options = load_options(),
+                                         cpu_feature_set host = host_cpu_features())
+{
+  auto order = detail::rank_candidates(candidates.data(), candidates.size(), host);
+  if (order.empty())
+  {
+    const std::string host_names = cpu_feature_names(host);
+    throw std::runtime_error("[dynamic_library] error: No library variant is supported by this CPU (" +
+                             (host_names.empty() ? std::string("no optional features") : host_names) + ")");
+  }
+  std::string errors;
+  for (std::size_t i : order)
+  {
+    try
+    {
+      return dynamic_library(candidates[i].path, options);
+    }
+    catch (const std::exception &e)
+    {
+      errors += "\n  ";
+      errors += e.what();
+    }
+  }
+  throw std::runtime_error("[dynamic_library] error: Failed to load any supported library variant:" + errors);
+}
+
+/// @brief 同一动态库内同一函数的一个实现版本(符号名称)及其要求的 CPU 特性
+struct cpu_symbol_variant
+{
+  const char *name;          // 符号名称
+  cpu_feature_set required;  // 运行该实现需要的特性
+};
+
+/**
+ * @brief 按 CPU 特性绑定同一函数的最优实现(类似 GNU ifunc, 但在加载后由调用者选择)
+ *
+ *   auto transform = dll::bind_best<void(const point_t *, point_t *, size_t)>(
+ *     lib, {{"transform_avx512", dll::cpu_feature::avx512f}, {"transform_avx2", dll::cpu_feature::avx2},
+ *           {"transform", dll::cpu_feature::none}});
+ *
+ * @tparam F 函数类型
+ * @param lib 已加载的动态库
+ * @param variants 候选实现, 动态库中不存在的符号会被跳过
+ * @param host CPU 特性, 默认为当前 CPU
+ * @return 最优实现的函数句柄
+ * @throw std::runtime_error 没有既可运行又存在于动态库中的实现时抛出异常
+ */
+template <typename F>
+bound_symbol<F> bind_best(const dynamic_library &lib, std::initializer_list<cpu_symbol_variant> variants,
+                          cpu_feature_set host = host_cpu_features())
+{
+  for (std::size_t i : detail::rank_candidates(variants.begin(), variants.size(), host))
+  {
+    bound_symbol<F> fn = lib.try_bind<F>(variants.begin()[i].name);
+    if (fn.valid()) return fn;
+  }
+  std::string names;
+  for (const auto &v : variants)
+  {
+    if (!names.empty()) names += ", ";
+    names += v.name;
+  }
+  throw std::runtime_error("[dynamic_library] error: No supported implementation found among: " + names);
+}
+
+}  // namespace dll
+
+#endif  // DYNAMIC_LIBRARY_CPU_DISPATCH_H
@@ -13,6 +13,23 @@
  *      when failing to load the library or symbols.
  *    - Symbol Caching: `invoke()` supports symbol caching for improved efficiency.
  *    - Cached and Uncached Interfaces: Use `invoke()` (cached) or `invoke_uncached()` (non-cached).
+ *    - Lock-free Cache Mode: `cache_mode::lock_free` makes cache hits wait-free (no mutex on the read path).
+ *    - Thread-local Cache Tier: `cache_mode::thread_local_tier` serves hot symbols from a small per-thread cache,
+ *      so cache hits touch no cache lines shared with other threads.
+ *    - Bound Symbols: `bind<F>()` resolves a function once and returns a callable handle that detects reload/unload.
+ *    - Symbol Tables: `DLL_SYMBOL_TABLE` declares a whole plugin interface, `load_table<T>()` resolves it in one pass.
+ *    - Plugin Descriptors: `load_descriptor<T>()` fetches a static function table through a single exported entry
+ *      point and validates its ABI version and struct layouts before any call is made.
+ *    - Allocation-free Lookups: symbol names accept `const char*`, `std::string` and (C++17) `std::string_view`.
+ *    - Export Index: `enable_export_index()` parses the ELF/PE export table once for O(1) lookups and enumeration.
+ *    - Compact Cache Storage: cache entries and names are interned into one arena behind a flat open-addressing
+ *      table; `clear_cache()`/`unload()` release the memory in bulk.
+ *    - Negative Caching: misses of `has_symbol()`/`try_get()` are cached too, repeated misses skip the loader.
+ *    - Load Options: `load_options` selects dlopen/LoadLibraryEx flags and warms up symbols right after loading.
+ *    - Lazy Loading: `load_options::lazy` defers dlopen/LoadLibrary to the first symbol use (thread-safe, call_once).
+ *    - In-memory Loading: `load_from_memory()` loads an image from a buffer (memfd on Linux, no disk round trip).
+ *    - Tracing: `set_trace_callback()` reports load/unload time and per-symbol cache-hit/resolve time.
+ *    - Call Instrumentation: define `DLL_ENABLE_INSTRUMENTATION` to get per-symbol call counts and latency histograms.
  *    - No Dependencies: Relies solely on the standard library.
  *
  * @author: abin
@@ -26,12 +43,49 @@
 #ifndef DYNAMIC_LIBRARY_H
 #define DYNAMIC_LIBRARY_H
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <initializer_list>
+#include <memory>
 #include <mutex>
+#include <new>
 #include <stdexcept>
 #include <string>
+#include <system_error>
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
+#include <vector>
+
+#ifdef DLL_ENABLE_INSTRUMENTATION
+#include <cstdio>
+#endif
+
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#include <string_view>
+#define DYNAMIC_LIBRARY_HAS_STRING_VIEW 1
+#endif
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <unistd.h>  // write/close/unlink(从内存加载)
+
+#include <cerrno>
+#include <cstdlib>  // mkstemp/getenv
+#if defined(__linux__)
+#include <fcntl.h>        // F_DUPFD_CLOEXEC
+#include <sys/syscall.h>  // SYS_memfd_create
+#endif
+#endif
+
+#if __cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+#include <span>
+#define DYNAMIC_LIBRARY_HAS_SPAN 1
+#endif
 
 namespace dll
 {
@@ -55,6 +109,57 @@ struct symbol_pointer_traits
 template <typename T>
 using symbol_pointer_t = typename symbol_pointer_traits<T>::type;
 
+/// @brief 符号名称视图, 统一接收 `const char*`、`std::string` 和 `std::string_view`(C++17), 查找时不分配内存
+///        - dlsym/GetProcAddress 需要以 '\0' 结尾的字符串: `const char*` 与 `std::string` 直接引用原字符串,
+///          `std::string_view` 复制到内部栈缓冲区(超长名称才会回退到堆分配)
+///        - 只用作函数参数(绑定到临时对象), 不可拷贝
+class name_ref
+{
+ public:
+  name_ref(const char *name) noexcept : data_(name), size_(std::strlen(name)) {}
+  name_ref(const std::string &name) noexcept :
+    data_(name.c_str()), size_(name.size())
+  {
+  }
+#ifdef DYNAMIC_LIBRARY_HAS_STRING_VIEW
+  name_ref(std::string_view name) : size_(name.size())
+  {
+    if (name.size() < sizeof(buf_))
+    {
+      std::memcpy(buf_, name.data(), name.size());
+      buf_[name.size()] = '\0';
+      data_ = buf_;
+    }
+    else
+    {
+      owned_.assign(name.data(), name.size());
+      data_ = owned_.c_str();
+    }
+  }
+#endif
+  name_ref(const name_ref &) = delete;
+  name_ref &operator=(const name_ref &) = delete;
+
+  /// @brief 以 '\0' 结尾的名称
+  const char *c_str() const noexcept
+  {
+    return data_;
+  }
+
+  std::size_t size() const noexcept
+  {
+    return size_;
+  }
+
+ private:
+  const char *data_;
+  std::size_t size_;
+#ifdef DYNAMIC_LIBRARY_HAS_STRING_VIEW
+  char buf_[128];
+  std::string owned_;
+#endif
+};
+
 // 定义平台相关的动态库 API
 #if defined(_WIN32) || defined(_WIN64)
 // 避免 <windows.h> 引入过多无关内容(如 Sockets、RPC、OLE 等), 减少编译时间与命名冲突
@@ -67,11 +172,100 @@ using symbol_pointer_t = typename symbol_pointer_traits<T>::type;
 #endif
 #include <windows.h>
 
+#ifndef LOAD_LIBRARY_SEARCH_DLL_LOAD_DIR  // Windows 8 之前的 SDK 没有定义(Windows 7 需要 KB2533623)
+#define LOAD_LIBRARY_SEARCH_DLL_LOAD_DIR 0x00000100
+#define LOAD_LIBRARY_SEARCH_DEFAULT_DIRS 0x00001000
+#endif
+
 using library_handle = HMODULE;
+using load_flags_t = DWORD;                             // LoadLibraryEx 的 dwFlags
+constexpr load_flags_t default_load_flags = 0;         // 0 等价于 LoadLibraryW(默认搜索顺序)
+constexpr load_flags_t search_flags_mask = 0x00001F00;  // LOAD_LIBRARY_SEARCH_* 标志位
+/// 只在已知目录中搜索: 动态库所在目录、应用目录、System32 以及 AddDllDirectory 添加的目录
+constexpr load_flags_t restricted_search_flags = LOAD_LIBRARY_SEARCH_DLL_LOAD_DIR | LOAD_LIBRARY_SEARCH_DEFAULT_DIRS;
+
+/// @brief UTF-8 路径转为 UTF-16; 不是合法 UTF-8 时按 ANSI 代码页转换(兼容之前交给 LoadLibraryA 的本地编码路径)
+inline std::wstring widen_path(const std::string &path)
+{
+  if (path.empty()) return std::wstring();
+  const int len = static_cast<int>(path.size());
+  UINT codepage = CP_UTF8;
+  DWORD flags = MB_ERR_INVALID_CHARS;
+  int n = MultiByteToWideChar(codepage, flags, path.data(), len, nullptr, 0);
+  if (n <= 0)
+  {
+    codepage = CP_ACP;
+    flags = 0;
+    n = MultiByteToWideChar(codepage, flags, path.data(), len, nullptr, 0);
+  }
+  std::wstring wide(n > 0 ? static_cast<std::size_t>(n) : 0, L'\0');
+  if (n > 0) MultiByteToWideChar(codepage, flags, path.data(), len, &wide[0], n);
+  return wide;
+}
+
+/// @brief UTF-16 路径转为 UTF-8
+inline std::string narrow_path(const std::wstring &path)
+{
+  if (path.empty()) return std::string();
+  const int len = static_cast<int>(path.size());
+  const int n = WideCharToMultiByte(CP_UTF8, 0, path.data(), len, nullptr, 0, nullptr, nullptr);
+  std::string narrow(n > 0 ? static_cast<std::size_t>(n) : 0, '\0');
+  if (n > 0) WideCharToMultiByte(CP_UTF8, 0, path.data(), len, &narrow[0], n, nullptr, nullptr);
+  return narrow;
+}
+
+/// @brief 转为完整路径(相对当前目录, 不受 MAX_PATH 限制), 失败时保持原样
+inline std::wstring full_path(const std::wstring &path)
+{
+  DWORD n = GetFullPathNameW(path.c_str(), 0, nullptr, nullptr);
+  if (n == 0) return path;
+  std::wstring full(n, L'\0');
+  n = GetFullPathNameW(path.c_str(), n, &full[0], nullptr);
+  if (n == 0 || n >= full.size()) return path;
+  full.resize(n);
+  return full;
+}
+
+/// @brief 路径按 UTF-8 解释, 通过 LoadLibraryExW 加载(支持非 ASCII 路径)
+///        - 含目录的路径先转为完整路径: LOAD_LIBRARY_SEARCH_DLL_LOAD_DIR 要求完整路径, 也避免相对路径的搜索
+///        - 不含目录的库名交给系统搜索, 去掉只对完整路径有效的 LOAD_LIBRARY_SEARCH_DLL_LOAD_DIR
+inline library_handle load_library(const std::string &path, load_flags_t flags = default_load_flags) noexcept
+{
+  try
+  {
+    std::wstring wide = widen_path(path);
+    if (wide.find_first_of(L"\\/") != std::wstring::npos)
+    {
+      wide = full_path(wide);
+    }
+    else
+    {
+      flags &= ~static_cast<load_flags_t>(LOAD_LIBRARY_SEARCH_DLL_LOAD_DIR);
+    }
+    return LoadLibraryExW(wide.c_str(), nullptr, flags);
+  }
+  catch (const std::bad_alloc &)
+  {
+    SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+    return nullptr;
+  }
+}
 
-inline library_handle load_library(const std::string &path) noexcept
+/// @brief 已加载模块的完整路径(UTF-8), 失败时返回空字符串
+inline std::string module_path(library_handle handle)
 {
-  return LoadLibraryA(path.c_str());
+  std::wstring buf(MAX_PATH, L'\0');
+  for (;;)
+  {
+    const DWORD n = GetModuleFileNameW(handle, &buf[0], static_cast<DWORD>(buf.size()));
+    if (n == 0) return std::string();
+    if (n < buf.size())
+    {
+      buf.resize(n);
+      return narrow_path(buf);
+    }
+    buf.resize(buf.size() * 2);  // 被截断, 扩大缓冲重试
+  }
 }
 
 inline void unload_library(library_handle handle) noexcept
@@ -83,9 +277,9 @@ inline void unload_library(library_handle handle) noexcept
 }
 
 template <typename F>
-inline symbol_pointer_t<F> load_symbol(library_handle handle, const std::string &name) noexcept
+inline symbol_pointer_t<F> load_symbol(library_handle handle, const char *name) noexcept
 {
-  return reinterpret_cast<symbol_pointer_t<F>>(GetProcAddress(handle, name.c_str()));
+  return reinterpret_cast<symbol_pointer_t<F>>(GetProcAddress(handle, name));
 }
 
 inline std::string get_last_error()
@@ -113,11 +307,31 @@ inline std::string get_last_error()
 #else
 
 #include <dlfcn.h>
+#if defined(__linux__)
+#include <link.h>  // 解析 ELF 动态符号表(导出索引)
+#endif
 using library_handle = void *;
+using load_flags_t = int;                                // dlopen 的 mode
+constexpr load_flags_t default_load_flags = RTLD_LAZY;  // 延迟绑定
+
+inline library_handle load_library(const std::string &path, load_flags_t flags = default_load_flags) noexcept
+{
+  return dlopen(path.c_str(), flags);
+}
 
-inline library_handle load_library(const std::string &path) noexcept
+/// @brief 已加载动态库的完整路径(Linux 取自 link_map), 无法获取时返回空字符串
+inline std::string module_path(library_handle handle)
 {
-  return dlopen(path.c_str(), RTLD_LAZY);
+#if defined(__linux__)
+  struct link_map *map = nullptr;
+  if (dlinfo(handle, RTLD_DI_LINKMAP, &map) == 0 && map != nullptr && map->l_name != nullptr && map->l_name[0] == '/')
+  {
+    return map->l_name;
+  }
+#else
+  (void)handle;
+#endif
+  return std::string();
 }
 
 inline void unload_library(library_handle handle) noexcept
@@ -129,10 +343,10 @@ inline void unload_library(library_handle handle) noexcept
 }
 
 template <typename F>
-inline symbol_pointer_t<F> load_symbol(library_handle handle, const std::string &name) noexcept
+inline symbol_pointer_t<F> load_symbol(library_handle handle, const char *name) noexcept
 {
   dlerror();  // 清除之前的错误
-  return reinterpret_cast<symbol_pointer_t<F>>(dlsym(handle, name.c_str()));
+  return reinterpret_cast<symbol_pointer_t<F>>(dlsym(handle, name));
 }
 
 inline std::string get_last_error()
@@ -142,238 +356,1599 @@ inline std::string get_last_error()
 }
 #endif
 
-}  // namespace detail
-
-using detail::library_handle;
-
-/// @brief 动态库加载类, 使用 RAII 管理动态库资源
-class dynamic_library
+/// @brief 拼接异常信息(只分配一次): "[dynamic_library] error: <what>: '<name>' <reason>"
+inline std::string format_error(const char *what, const char *name, std::size_t len, const std::string &reason)
 {
-  template <typename T>
-  using symbol_pointer_t = typename detail::symbol_pointer_t<T>;
+  static const char prefix[] = "[dynamic_library] error: ";
+  const std::size_t what_len = std::strlen(what);
+  std::string msg;
+  msg.reserve(sizeof(prefix) + what_len + len + reason.size() + 5);
+  msg.append(prefix, sizeof(prefix) - 1).append(what, what_len).append(": '", 3);
+  msg.append(name, len).append("' ", 2).append(reason);
+  return msg;
+}
 
+/**
+ * @brief 把内存中的动态库映像放到系统加载器能打开的位置, 析构时清理
+ *
+ * - Linux: memfd_create 创建匿名内存文件, 通过 /proc/self/fd/N 加载, 不经过任何文件系统;
+ *   memfd 不可用(内核过旧或被 seccomp 禁止)时回退为临时文件
+ * - 其他 POSIX: $TMPDIR(默认 /tmp)下的临时文件, 加载后即可删除(映射仍然有效)
+ * - Windows: 系统加载器只能加载文件, 写入 FILE_ATTRIBUTE_TEMPORARY 临时文件(尽量只留在缓存中);
+ *   文件在映射期间不能删除, 由 release() 交给 dynamic_library 在卸载后删除
+ */
+class memory_image
+{
  public:
-  dynamic_library() = default;  // 默认构造函数, handle_为nullptr
-
-  /**
-   * @brief 构造函数, 加载指定路径的动态库
-   * @param libPath 动态库路径
-   * @throw std::runtime_error 如果加载失败, 则抛出异常
-   */
-  explicit dynamic_library(const std::string &libPath)
+  /// @throw std::runtime_error 创建或写入失败时抛出异常
+  memory_image(const void *data, std::size_t size, const std::string &name)
   {
-    load_handle(libPath);
+#if defined(_WIN32) || defined(_WIN64)
+    wchar_t dir[MAX_PATH + 1];
+    wchar_t file[MAX_PATH];
+    const DWORD n = GetTempPathW(MAX_PATH + 1, dir);  // 用户目录可能含非 ASCII 字符, 使用宽字符接口
+    if (n == 0 || n > MAX_PATH || GetTempFileNameW(dir, L"dll", 0, file) == 0) fail(name, get_last_error());
+    file_ = file;
+    path_ = narrow_path(file_);
+    HANDLE h = CreateFileW(file, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_TEMPORARY, nullptr);
+    if (h == INVALID_HANDLE_VALUE) fail(name, get_last_error());
+    const char *p = static_cast<const char *>(data);
+    while (size > 0)
+    {
+      const DWORD chunk = size > 0x40000000 ? 0x40000000 : static_cast<DWORD>(size);
+      DWORD written = 0;
+      if (!WriteFile(h, p, chunk, &written, nullptr) || written == 0)
+      {
+        const std::string reason = get_last_error();
+        CloseHandle(h);
+        fail(name, reason);
+      }
+      p += written;
+      size -= written;
+    }
+    CloseHandle(h);
+#else
+#if defined(__linux__) && defined(SYS_memfd_create)
+    fd_ = static_cast<int>(::syscall(SYS_memfd_create, name.c_str(), 0x0001U));  // MFD_CLOEXEC
+    if (fd_ >= 0) path_ = "/proc/self/fd/" + std::to_string(fd_);
+#endif
+    if (fd_ < 0)
+    {
+      const char *dir = std::getenv("TMPDIR");
+      std::string pattern = std::string(dir && *dir ? dir : "/tmp") + "/dynamic_library_XXXXXX";
+      fd_ = ::mkstemp(&pattern[0]);
+      if (fd_ < 0) fail(name, std::strerror(errno));
+      path_ = pattern;
+      unlink_ = true;
+    }
+    const char *p = static_cast<const char *>(data);
+    while (size > 0)
+    {
+      const ssize_t written = ::write(fd_, p, size);
+      if (written < 0 && errno == EINTR) continue;
+      if (written <= 0) fail(name, std::strerror(errno));
+      p += written;
+      size -= static_cast<std::size_t>(written);
+    }
+#if defined(__linux__)
+    if (!unlink_) make_unique_name();
+#endif
+#endif
   }
 
-  /// @brief 析构函数 - 自动卸载动态库
-  ~dynamic_library()
+  ~memory_image()
   {
-    unload_handle();
+    cleanup();
   }
 
-  // 禁用拷贝语义, 防止拷贝可能导致的资源管理问题
-  dynamic_library(const dynamic_library &) = delete;
-  dynamic_library &operator=(const dynamic_library &) = delete;
+  memory_image(const memory_image &) = delete;
+  memory_image &operator=(const memory_image &) = delete;
 
-  // 支持移动语义, 便于资源的安全转移 - 移动构造
-  dynamic_library(dynamic_library &&other) noexcept : handle_(other.handle_), cache_(std::move(other.cache_))
+  /// @brief 交给系统加载器的路径
+  const std::string &path() const noexcept
   {
-    other.handle_ = nullptr;
+    return path_;
   }
 
-  // 支持移动语义, 便于资源的安全转移 - 移动赋值
-  dynamic_library &operator=(dynamic_library &&rhs) noexcept
+  /// @brief 加载成功后调用: 返回需要在卸载后删除的文件(只有 Windows 非空), 析构时不再删除
+  std::string release()
   {
-    // 常规实现方式
-    // if (this != &rhs)
-    // {
-    //   if (handle_)  // 卸载自身句柄
-    //   {
-    //     detail::unload_library(handle_);
-    //   }
-    //   handle_ = rhs.handle_;
-    //   cache_ = std::move(rhs.cache_);
-    //   rhs.handle_ = nullptr;
-    //   rhs.cache_.clear();
-    // }
-
-    // move-and-swap方式(自赋值安全, 异常安全)
-    dynamic_library tmp(std::move(rhs));  // tmp 用移动构造拿走 rhs 的资源
-    swap(*this, tmp);                     // 当前对象和 tmp 交换, tmp 拿到旧资源
-    return *this;                         // tmp 析构, 释放旧资源
+#if defined(_WIN32) || defined(_WIN64)
+    std::string file;
+    file.swap(path_);
+    file_.clear();
+    return file;
+#else
+    return std::string();
+#endif
   }
 
-  // swap 函数：强异常安全, 供移动赋值使用
-  friend void swap(dynamic_library &lhs, dynamic_library &rhs) noexcept
+ private:
+  void cleanup() noexcept
   {
-    using std::swap;
-    swap(lhs.handle_, rhs.handle_);
-    swap(lhs.cache_, rhs.cache_);
+#if defined(_WIN32) || defined(_WIN64)
+    if (!file_.empty()) DeleteFileW(file_.c_str());
+    file_.clear();
+    path_.clear();
+#else
+    if (fd_ >= 0) ::close(fd_);  // 加载器已建立映射, 关闭描述符不影响已加载的动态库
+    if (unlink_) ::unlink(path_.c_str());
+    fd_ = -1;
+    unlink_ = false;
+#endif
   }
 
-  /// @brief 检查动态库是否已加载
-  explicit operator bool() const noexcept
+#if defined(__linux__)
+  /// @brief glibc 先按名称匹配已加载的库: 描述符号被回收后, "/proc/self/fd/N" 可能仍是之前某个映像(未真正卸载)
+  ///        的名称, 此时 dlopen 会直接返回旧的库. 换用新的描述符号, 直到名称没有被占用
+  void make_unique_name()
   {
-    return valid();
+    std::vector<int> taken;
+    while (void *loaded = dlopen(path_.c_str(), RTLD_LAZY | RTLD_NOLOAD))
+    {
+      dlclose(loaded);
+      const int fd = ::fcntl(fd_, F_DUPFD_CLOEXEC, 0);
+      if (fd < 0) break;
+      taken.push_back(fd_);  // 保持打开, 保证下一次得到不同的描述符号
+      fd_ = fd;
+      path_ = "/proc/self/fd/" + std::to_string(fd_);
+    }
+    for (int fd : taken) ::close(fd);
   }
+#endif
 
-  /// @brief 检查动态库中是否存在指定符号, 如果符号存在 返回 true 否则返回 false
-  bool has_symbol(const std::string &name) const noexcept
+  /// @brief 构造函数中抛出异常不会调用析构函数, 先清理已创建的资源再抛出
+  [[noreturn]] void fail(const std::string &name, const std::string &reason)
   {
-    {
-      std::lock_guard<std::mutex> lock(mtx_);
-      if (cache_.find(name) != cache_.end()) return true;  // 先查缓存
-    }
-    void *sym = try_get<void>(name);
-    if (sym != nullptr)
-    {
-      std::lock_guard<std::mutex> lock(mtx_);
-      cache_[name] = sym;  // 添加缓存
-      return true;
-    }
-    return false;
+    cleanup();
+    throw std::runtime_error(format_error("Failed to stage library image", name.c_str(), name.size(), reason));
   }
 
-  /**
-   * @brief 加载动态库中的符号(函数或变量), 加载失败抛出异常
-   *
-   * @tparam F 要获取的符号类型, 可以是函数类型(如 int(int, int))或变量指针类型(如 int*、const char**)
-   * @param symbol_name 符号名称(区分大小写)
-   * @return 符号地址, 类型为 symbol_pointer_t<F>
-   * @throw std::runtime_error 加载失败时抛出异常, 包含符号名和错误信息
-   *
-   * @note 获取变量推荐使用 get_variable<T>()
-   */
-  template <typename F>
-  symbol_pointer_t<F> get(const std::string &symbol_name) const
+  std::string path_;
+#if defined(_WIN32) || defined(_WIN64)
+  std::wstring file_;  // 临时文件的 UTF-16 路径(path_ 为其 UTF-8 形式)
+#else
+  int fd_{-1};
+  bool unlink_{false};  // 是否为需要删除的临时文件
+#endif
+};
+
+/// @brief 删除 load_from_memory 留下的临时文件
+inline void remove_file(const std::string &path) noexcept
+{
+#if defined(_WIN32) || defined(_WIN64)
+  try
   {
-    if (!handle_)
-    {
-      throw std::runtime_error("[dynamic_library] error: Dynamic library not loaded");
-    }
-    auto symbol = detail::load_symbol<F>(handle_, symbol_name);
-    if (!symbol)
-    {
-      throw std::runtime_error("[dynamic_library] error: Failed to load symbol: '" + symbol_name + "' " +
-                               detail::get_last_error());
-    }
-    return symbol;
+    DeleteFileW(widen_path(path).c_str());
   }
+  catch (const std::bad_alloc &)
+  {
+  }
+#else
+  ::unlink(path.c_str());
+#endif
+}
 
-  /**
-   * @brief 尝试加载动态库中的符号(函数或变量), 失败返回 nullptr(不会抛出异常)
-   *
-   * @tparam F 符号类型(函数或变量指针类型)
-   * @param symbol_name 符号名称(区分大小写)
-   * @return 成功返回符号地址, 失败返回 nullptr
-   *
-   * @note 获取变量推荐使用 try_get_variable<T>()
-   */
-  template <typename F>
-  symbol_pointer_t<F> try_get(const std::string &symbol_name) const noexcept
+/**
+ * @brief 库名解析缓存: 不含目录的库名(交给系统搜索)第一次加载成功后记录解析到的完整路径,
+ *        之后按同一库名加载时直接加载该路径, 跳过搜索(Windows 的 DLL 搜索顺序每次都要依次探测多个目录)
+ *
+ * - 键为规范化的库名(Windows 忽略大小写) + 加载标志, 值为 UTF-8 完整路径
+ * - 缓存的路径加载失败(文件被移走等)时删除条目, 回退为按库名搜索
+ * - 只在 load_options::cache_path 时使用(默认关闭): 缓存的路径会绕过之后 SetDllDirectory/AddDllDirectory、
+ *   工作目录或 PATH 的变化, 以及重新安装到其他位置的同名库
+ */
+class path_cache
+{
+ public:
+  static path_cache &instance()
   {
-    if (!handle_) return nullptr;
-    return detail::load_symbol<F>(handle_, symbol_name);
+    static path_cache cache;
+    return cache;
   }
 
-  /**
-   * @brief 加载动态库中的变量, 失败抛出异常
-   *
-   * @tparam T 变量的基础类型，如 int、double、const char*、MyStruct 等(非函数类型)
-   * @param variable_name 变量符号名称(区分大小写)
-   * @return 返回变量的引用
-   * @throw std::runtime_error 加载失败抛出异常
-   */
-  template <typename T, typename std::enable_if<!std::is_function<detail::remove_ptr_ref_t<T>>::value, int>::type = 0>
-  T &get_variable(const std::string &variable_name) const
+  /// @brief 缓存键, 含目录的路径不需要搜索, 返回空字符串(不缓存)
+  static std::string key(const std::string &name, load_flags_t flags)
   {
-    T *var_ptr = try_get<T *>(variable_name);
-    if (!var_ptr)
+#if defined(_WIN32) || defined(_WIN64)
+    if (name.empty() || name.find_first_of("\\/") != std::string::npos) return std::string();
+    std::string key = name;
+    for (auto &c : key)
     {
-      throw std::runtime_error("[dynamic_library] error: Failed to load variable: '" + variable_name + "' " +
-                               detail::get_last_error());
+      if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
     }
-    return *var_ptr;
+#else
+    if (name.empty() || name.find('/') != std::string::npos) return std::string();
+    std::string key = name;
+#endif
+    key += '|';
+    key += std::to_string(flags);
+    return key;
   }
 
-  /**
-   * @brief 尝试加载动态库中的变量, 成功返回变量地址, 失败返回 nullptr(不会抛出异常)
-   *
-   * @tparam T 变量的基础类型，如 int、double、const char*、MyStruct 等(非函数类型)
-   * @param variable_name 变量符号名称(区分大小写)
-   * @return 返回变量指针, 加载失败返回 nullptr
-   */
-  template <typename T, typename std::enable_if<!std::is_function<detail::remove_ptr_ref_t<T>>::value, int>::type = 0>
-  T *try_get_variable(const std::string &variable_name) const noexcept
+  /// @brief 查找库名上次解析到的完整路径, 没有时返回空字符串
+  std::string find(const std::string &key) const
   {
-    return try_get<T *>(variable_name);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = paths_.find(key);
+    return it != paths_.end() ? it->second : std::string();
   }
 
-  /**
-   * @brief 调用动态库中的符号, 支持参数转发(调用后会缓存函数)
-   *
-   * @tparam F 函数指针类型, 用于指定要调用的符号对应的函数类型
-   * @tparam Args 可变参数模板, 用于指定传递给函数的参数类型
-   * @param symbol_name 符号名称, 指定要调用的符号的名称
-   * @param args 可变参数, 传递给函数的参数
-   * @return 返回函数调用的结果
-   * @throw `std::runtime_error` 如果加载符号失败, 则抛出异常
-   *
-   * @note 该函数会尝试加载并调用动态库中的指定符号.如果符号不存在或加载失败,
-   *       会抛出 `std::runtime_error` 异常.使用此函数时需确保符号名称正确.
-   */
-  template <typename F, typename... Args>
-  auto invoke(const std::string &symbol_name, Args... args) const
-    -> decltype(std::declval<F>()(std::forward<Args>(args)...))
+  void store(const std::string &key, const std::string &path)
   {
-    using func_ptr = symbol_pointer_t<F>;
-    func_ptr symbol = nullptr;
-    {
-      std::lock_guard<std::mutex> lock(mtx_);
-      auto it = cache_.find(symbol_name);  // 查找缓存
-      if (it != cache_.end())              // 找到了符号
-      {
-        symbol = reinterpret_cast<func_ptr>(it->second);
-      }
-    }
-    if (!symbol)  // 未找到符号
-    {
-      symbol = get<F>(symbol_name);  // 加载符号, 加载失败抛异常
-      {
-        std::lock_guard<std::mutex> lock(mtx_);
-        cache_.emplace(symbol_name, reinterpret_cast<void *>(symbol));  // 添加缓存
-      }
-    }
-    return symbol(std::forward<Args>(args)...);  // 调用函数
+    if (path.empty()) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    paths_[key] = path;
   }
 
-  /**
-   * @brief 调用动态库中的符号, 支持参数转发(不使用缓存)
-   *
-   * @tparam F 函数指针类型, 用于指定要调用的符号对应的函数类型
-   * @tparam Args 可变参数模板, 用于指定传递给函数的参数类型
-   * @param symbol_name 符号名称, 指定要调用的符号的名称
-   * @param args 可变参数, 传递给函数的参数
-   * @return 返回函数调用的结果
-   * @throw `std::runtime_error` 如果加载符号失败, 则抛出异常
-   *
-   * @note 该函数会尝试加载并调用动态库中的指定符号.如果符号不存在或加载失败,
-   *       会抛出 `std::runtime_error` 异常.使用此函数时需确保符号名称正确.
-   */
-  template <typename F, typename... Args>
-  auto invoke_uncached(const std::string &symbol_name, Args... args) const
-    -> decltype(std::declval<F>()(std::forward<Args>(args)...))
+  void erase(const std::string &key)
   {
-    return get<F>(symbol_name)(std::forward<Args>(args)...);  // 直接调用函数
+    std::lock_guard<std::mutex> lock(mutex_);
+    paths_.erase(key);
+  }
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    paths_.clear();
+  }
+
+  std::size_t size() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return paths_.size();
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, std::string> paths_;  // 缓存键 -> 完整路径
+};
+
+/// @brief FNV-1a 哈希, 用于符号缓存
+inline std::size_t hash_name(const char *name, std::size_t len) noexcept
+{
+  std::size_t h = sizeof(std::size_t) == 8 ? static_cast<std::size_t>(14695981039346656037ULL) : 2166136261U;
+  const std::size_t prime = sizeof(std::size_t) == 8 ? static_cast<std::size_t>(1099511628211ULL) : 16777619U;
+  for (std::size_t i = 0; i < len; ++i)
+  {
+    h ^= static_cast<unsigned char>(name[i]);
+    h *= prime;
+  }
+  return h;
+}
+
+/// @brief 只增不释放的内存池: 从按倍数增长的大块中顺序分配, clear() 时整体释放
+///        - 所有分配按指针大小对齐, 用于存放符号缓存项与名称, 每项不再单独分配内存
+///        - 已分配的内存在 clear() 之前地址不变(无锁读者可以安全持有指针)
+class cache_arena
+{
+ public:
+  cache_arena() = default;
+  cache_arena(const cache_arena &) = delete;
+  cache_arena &operator=(const cache_arena &) = delete;
+
+  static constexpr std::size_t min_block_size = 512;        // 第一个块的大小
+  static constexpr std::size_t max_block_size = 16 * 1024;  // 块大小增长上限(更大的请求单独分配)
+
+  /// @brief 分配 bytes 字节(按指针大小对齐), 内存不足时抛出 std::bad_alloc
+  void *allocate(std::size_t bytes)
+  {
+    bytes = (bytes + alignment - 1) & ~(alignment - 1);
+    if (bytes > static_cast<std::size_t>(end_ - pos_))
+    {
+      std::size_t size = block_size_ == 0 ? min_block_size : block_size_ * 2;
+      if (size > max_block_size) size = max_block_size;
+      if (bytes > size) size = bytes;  // 超大请求独占一个块, 不影响之后的块大小
+      else block_size_ = size;
+      blocks_.reserve(blocks_.size() + 1);  // 先保证 push_back 不会失败, 避免泄漏新块
+      std::unique_ptr<char[]> block(new char[size]);
+      pos_ = block.get();
+      end_ = pos_ + size;
+      blocks_.push_back(std::move(block));
+      capacity_ += size;
+    }
+    void *p = pos_;
+    pos_ += bytes;
+    return p;
+  }
+
+  /// @brief 已向系统申请的字节数
+  std::size_t capacity() const noexcept
+  {
+    return capacity_;
+  }
+
+  /// @brief 整体释放所有块
+  void clear() noexcept
+  {
+    blocks_.clear();
+    blocks_.shrink_to_fit();
+    pos_ = end_ = nullptr;
+    block_size_ = 0;
+    capacity_ = 0;
+  }
+
+  friend void swap(cache_arena &lhs, cache_arena &rhs) noexcept
+  {
+    lhs.blocks_.swap(rhs.blocks_);
+    std::swap(lhs.pos_, rhs.pos_);
+    std::swap(lhs.end_, rhs.end_);
+    std::swap(lhs.block_size_, rhs.block_size_);
+    std::swap(lhs.capacity_, rhs.capacity_);
+  }
+
+ private:
+  static constexpr std::size_t alignment = alignof(void *) > alignof(std::size_t) ? alignof(void *)
+                                                                                  : alignof(std::size_t);
+
+  std::vector<std::unique_ptr<char[]>> blocks_;  // 所有块(最后一个为当前块)
+  char *pos_{nullptr};                            // 当前块的下一个可用位置
+  char *end_{nullptr};                            // 当前块末尾
+  std::size_t block_size_{0};                     // 当前块大小(不含单独分配的超大块)
+  std::size_t capacity_{0};                       // 所有块的总字节数
+};
+
+/// @brief 只增不删的开放寻址符号缓存, 按 (名称, 长度) 做异构查找, 探测时不构造 key
+///        - 缓存项与名称一起放在 cache_arena 中(名称紧跟在缓存项之后), 每项没有单独的堆分配, clear() 时整体释放
+///        - 同时缓存不存在的符号(值为 nullptr), 否定项数量有上限, 避免探测大量随机名称时无限增长
+///        - 读(find)可以不加锁且 wait-free: 只有原子 acquire 读取和有限次探测
+///        - 写(insert/clear)由调用者持有写锁串行化; 扩容时发布新表, 旧表保留到 clear() 时统一释放(RCU 风格)
+///        - clear() 要求没有并发读者(与 unload() 的要求一致)
+class symbol_cache
+{
+  struct entry
+  {
+    std::size_t hash;
+    void *value;
+    std::size_t len;
+    const char *name() const noexcept
+    {
+      return reinterpret_cast<const char *>(this + 1);  // 名称紧跟在缓存项之后, 以 '\0' 结尾
+    }
+  };
+
+  struct table
+  {
+    table(std::size_t capacity, const table *previous) :
+      mask(capacity - 1), slots(new std::atomic<const entry *>[capacity]), retired(previous)
+    {
+      for (std::size_t i = 0; i < capacity; ++i) slots[i].store(nullptr, std::memory_order_relaxed);
+    }
+    std::size_t mask;
+    std::unique_ptr<std::atomic<const entry *>[]> slots;
+    std::unique_ptr<const table> retired;  // 扩容前的旧表(可能仍有无锁读者), 随新表一起释放
+  };
+
+ public:
+  symbol_cache() = default;
+  symbol_cache(const symbol_cache &) = delete;
+  symbol_cache &operator=(const symbol_cache &) = delete;
+  ~symbol_cache()
+  {
+    clear();
+  }
+
+  static constexpr std::size_t max_negative_entries = 4096;  // 否定缓存项上限
+
+  /// @brief 查找缓存(无锁), 命中返回 true 并输出缓存值, 值为 nullptr 表示已知不存在的符号
+  bool find(const char *name, std::size_t len, void *&value) const noexcept
+  {
+    const char *stored = nullptr;
+    return find(name, len, hash_name(name, len), value, stored);
+  }
+
+  /// @brief 按已计算的哈希查找缓存(无锁), 命中时 stored 输出缓存项中的名称(在 clear() 之前有效)
+  bool find(const char *name, std::size_t len, std::size_t h, void *&value, const char *&stored) const noexcept
+  {
+    const table *t = table_.load(std::memory_order_acquire);
+    if (t == nullptr) return false;
+    for (std::size_t i = h & t->mask;; i = (i + 1) & t->mask)  // 负载因子不超过 1/2, 必然遇到空槽
+    {
+      const entry *e = t->slots[i].load(std::memory_order_acquire);
+      if (e == nullptr) return false;
+      if (e->hash == h && e->len == len && std::memcmp(e->name(), name, len) == 0)
+      {
+        value = e->value;
+        stored = e->name();
+        return true;
+      }
+    }
+  }
+
+  /// @brief 插入缓存(调用者需持有写锁), 已存在则忽略; value 为 nullptr 表示缓存"不存在"
+  void insert(const char *name, std::size_t len, void *value)
+  {
+    void *existing = nullptr;
+    if (find(name, len, existing)) return;
+    if (value == nullptr && negatives_ >= max_negative_entries) return;  // 否定项已满, 不再缓存
+    const table *t = table_.load(std::memory_order_relaxed);
+    if (t == nullptr || (size_ + 1) * 2 > t->mask + 1)  // 扩容: 新表填好后再原子发布
+    {
+      std::unique_ptr<table> bigger(new table(t == nullptr ? 16 : (t->mask + 1) * 2, t));
+      if (t != nullptr)
+      {
+        for (std::size_t i = 0; i <= t->mask; ++i)
+        {
+          const entry *e = t->slots[i].load(std::memory_order_relaxed);
+          if (e != nullptr) place(*bigger, e);
+        }
+      }
+      t = bigger.release();
+      table_.store(t, std::memory_order_release);
+    }
+    entry *e = static_cast<entry *>(arena_.allocate(sizeof(entry) + len + 1));
+    e->hash = hash_name(name, len);
+    e->value = value;
+    e->len = len;
+    char *stored = reinterpret_cast<char *>(e + 1);
+    std::memcpy(stored, name, len);
+    stored[len] = '\0';
+    place(*t, e);
+    ++size_;
+    if (value == nullptr) ++negatives_;
+  }
+
+  /// @brief 清空缓存并整体释放内存(调用者需持有写锁, 且没有并发读者)
+  void clear() noexcept
+  {
+    delete table_.exchange(nullptr, std::memory_order_acq_rel);  // 同时释放所有退役的旧表
+    arena_.clear();
+    size_ = 0;
+    negatives_ = 0;
+  }
+
+  /// @brief 缓存项数量(含否定项)
+  std::size_t size() const noexcept
+  {
+    return size_;
+  }
+
+  /// @brief 遍历当前所有缓存项(调用者需持有写锁), fn(name, len, value), value 为 nullptr 表示否定项
+  template <typename Fn>
+  void for_each(Fn &&fn) const
+  {
+    const table *t = table_.load(std::memory_order_relaxed);
+    if (t == nullptr) return;
+    for (std::size_t i = 0; i <= t->mask; ++i)
+    {
+      const entry *e = t->slots[i].load(std::memory_order_relaxed);
+      if (e != nullptr) fn(e->name(), e->len, e->value);
+    }
+  }
+
+  /// @brief 缓存占用的堆内存字节数(内存池 + 哈希表, 含退役的旧表)
+  std::size_t memory_usage() const noexcept
+  {
+    std::size_t bytes = arena_.capacity();
+    for (const table *t = table_.load(std::memory_order_relaxed); t != nullptr; t = t->retired.get())
+    {
+      bytes += sizeof(table) + (t->mask + 1) * sizeof(std::atomic<const entry *>);
+    }
+    return bytes;
+  }
+
+  friend void swap(symbol_cache &lhs, symbol_cache &rhs) noexcept
+  {
+    const table *t = lhs.table_.load(std::memory_order_relaxed);
+    lhs.table_.store(rhs.table_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    rhs.table_.store(t, std::memory_order_relaxed);
+    swap(lhs.arena_, rhs.arena_);
+    std::swap(lhs.size_, rhs.size_);
+    std::swap(lhs.negatives_, rhs.negatives_);
+  }
+
+ private:
+  static void place(const table &t, const entry *e) noexcept
+  {
+    std::size_t i = e->hash & t.mask;
+    while (t.slots[i].load(std::memory_order_relaxed) != nullptr) i = (i + 1) & t.mask;
+    t.slots[i].store(e, std::memory_order_release);  // 发布: 读者 acquire 后可见完整的 entry
+  }
+
+  std::atomic<const table *> table_{nullptr};  // 当前发布的表(拥有退役旧表组成的链)
+  cache_arena arena_;                          // 缓存项与名称的内存池(写锁保护)
+  std::size_t size_{0};                        // 缓存项数量
+  std::size_t negatives_{0};                   // 否定缓存项数量
+};
+
+/**
+ * @brief 每个线程私有的直接映射符号缓存(cache_mode::thread_local_tier 的第一级)
+ *
+ * - 槽位按 (缓存代数, 名称哈希) 选择, 缓存代数全局唯一, 同时区分动态库实例和每次 load/clear_cache,
+ *   因此失效只需更换代数, 旧槽位自然不再命中, 不需要通知其他线程
+ * - 名称指向共享缓存项中的字符串, 只有代数匹配时才会访问(代数更换之前共享缓存项不会释放)
+ */
+class thread_symbol_cache
+{
+ public:
+  static constexpr std::size_t slot_count = 64;  // 槽位数(2 的幂), 每线程约 2.5KB
+
+  struct slot
+  {
+    std::uint64_t generation;  // 写入时的缓存代数, 0 表示空槽
+    std::size_t hash;          // 名称哈希
+    const char *name;          // 名称(指向共享缓存项)
+    std::size_t len;           // 名称长度
+    void *value;               // 符号地址, nullptr 表示已知不存在
+  };
+
+  /// @brief 当前线程中 (generation, hash) 对应的槽位
+  static slot &at(std::uint64_t generation, std::size_t hash) noexcept
+  {
+    static thread_local slot slots[slot_count] = {};
+    const std::uint64_t mixed = (generation * 0x9E3779B97F4A7C15ULL) ^ hash;  // 不同实例的同名符号落在不同槽位
+    return slots[static_cast<std::size_t>(mixed ^ (mixed >> 32)) & (slot_count - 1)];
+  }
+};
+
+#ifdef DLL_ENABLE_INSTRUMENTATION
+/// @brief 单个符号的调用统计快照
+struct symbol_stats
+{
+  static constexpr std::size_t histogram_size = 32;  // 延迟直方图桶数, 第 i 个桶统计 [2^i, 2^(i+1)) 纳秒
+
+  std::string name;                              // 符号名称
+  std::uint64_t calls{0};                        // 调用次数
+  std::uint64_t total_ns{0};                     // 累计耗时(纳秒)
+  std::uint64_t max_ns{0};                       // 单次最大耗时(纳秒)
+  std::uint64_t histogram[histogram_size] = {};  // 延迟直方图(log2 分桶)
+
+  /// @brief 平均耗时(纳秒)
+  double mean_ns() const noexcept
+  {
+    return calls == 0 ? 0.0 : static_cast<double>(total_ns) / static_cast<double>(calls);
+  }
+
+  /// @brief 延迟分位数的上界(纳秒), 精度为直方图桶宽(2 倍), q 取值 [0, 1]
+  std::uint64_t percentile_ns(double q) const noexcept
+  {
+    if (calls == 0) return 0;
+    const double target = q * static_cast<double>(calls);
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < histogram_size; ++i)
+    {
+      seen += histogram[i];
+      if (static_cast<double>(seen) >= target && seen != 0) return std::min(max_ns, std::uint64_t(2) << i);
+    }
+    return max_ns;
+  }
+};
+
+/// @brief 单个符号的调用计数器, 按线程分片: 每个线程只写自己的分片(缓存行), 计数本身不产生竞争
+class symbol_counters
+{
+  struct shard
+  {
+    std::atomic<std::uint64_t> calls{0};
+    std::atomic<std::uint64_t> total_ns{0};
+    std::atomic<std::uint64_t> max_ns{0};
+    std::atomic<std::uint64_t> histogram[symbol_stats::histogram_size];
+    char padding[64];  // 与下一个分片隔开, 避免伪共享
+  };
+
+ public:
+  static constexpr std::size_t shard_count = 16;
+
+  explicit symbol_counters(std::string name) : name_(std::move(name))
+  {
+    reset();
+  }
+
+  /// @brief 记录一次调用(relaxed 原子加, 只写当前线程的分片)
+  void record(std::uint64_t ns) noexcept
+  {
+    shard &s = shards_[shard_index()];
+    s.calls.fetch_add(1, std::memory_order_relaxed);
+    s.total_ns.fetch_add(ns, std::memory_order_relaxed);
+    s.histogram[bucket(ns)].fetch_add(1, std::memory_order_relaxed);
+    std::uint64_t prev = s.max_ns.load(std::memory_order_relaxed);
+    while (ns > prev && !s.max_ns.compare_exchange_weak(prev, ns, std::memory_order_relaxed))
+    {
+    }
+  }
+
+  /// @brief 合并所有分片得到快照(与并发 record 之间不保证原子一致, 误差为正在进行中的调用)
+  symbol_stats snapshot() const
+  {
+    symbol_stats stats;
+    stats.name = name_;
+    for (const auto &s : shards_)
+    {
+      stats.calls += s.calls.load(std::memory_order_relaxed);
+      stats.total_ns += s.total_ns.load(std::memory_order_relaxed);
+      stats.max_ns = std::max(stats.max_ns, s.max_ns.load(std::memory_order_relaxed));
+      for (std::size_t i = 0; i < symbol_stats::histogram_size; ++i)
+      {
+        stats.histogram[i] += s.histogram[i].load(std::memory_order_relaxed);
+      }
+    }
+    return stats;
+  }
+
+  void reset() noexcept
+  {
+    for (auto &s : shards_)
+    {
+      s.calls.store(0, std::memory_order_relaxed);
+      s.total_ns.store(0, std::memory_order_relaxed);
+      s.max_ns.store(0, std::memory_order_relaxed);
+      for (auto &h : s.histogram) h.store(0, std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  /// @brief 当前线程的分片下标, 线程首次统计时分配
+  static std::size_t shard_index() noexcept
+  {
+    static std::atomic<std::size_t> counter{0};
+    thread_local std::size_t index = counter.fetch_add(1, std::memory_order_relaxed) % shard_count;
+    return index;
+  }
+
+  /// @brief log2 分桶: 0~1ns 落在第 0 个桶, 超出范围的落在最后一个桶
+  static std::size_t bucket(std::uint64_t ns) noexcept
+  {
+    std::size_t i = 0;
+    while (ns > 1 && i + 1 < symbol_stats::histogram_size)
+    {
+      ns >>= 1;
+      ++i;
+    }
+    return i;
+  }
+
+  std::string name_;
+  shard shards_[shard_count];
+};
+
+/// @brief 一个动态库的全部调用统计: 符号名称 -> 计数器, 查找复用 symbol_cache(读无锁)
+class call_profile
+{
+ public:
+  /// @brief 获取符号的计数器, 首次调用时创建; 内存不足时返回 nullptr(本次调用不统计)
+  symbol_counters *counters(const char *name, std::size_t len) noexcept
+  {
+    void *found = nullptr;
+    if (index_.find(name, len, found)) return static_cast<symbol_counters *>(found);
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (index_.find(name, len, found)) return static_cast<symbol_counters *>(found);
+    try
+    {
+      all_.push_back(std::unique_ptr<symbol_counters>(new symbol_counters(std::string(name, len))));
+      index_.insert(name, len, all_.back().get());
+      return all_.back().get();
+    }
+    catch (...)
+    {
+      return nullptr;
+    }
+  }
+
+  /// @brief 所有符号的统计快照, 按累计耗时从高到低排序
+  std::vector<symbol_stats> snapshot() const
+  {
+    std::vector<symbol_stats> result;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      result.reserve(all_.size());
+      for (const auto &c : all_) result.push_back(c->snapshot());
+    }
+    std::sort(result.begin(), result.end(),
+              [](const symbol_stats &a, const symbol_stats &b) { return a.total_ns > b.total_ns; });
+    return result;
+  }
+
+  /// @brief 清零所有计数器(计数器本身保留, 已绑定的句柄继续有效)
+  void reset() noexcept
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    for (auto &c : all_) c->reset();
+  }
+
+ private:
+  symbol_cache index_;                                 // 名称 -> 计数器, 只增不删
+  std::vector<std::unique_ptr<symbol_counters>> all_;  // 所有计数器(mtx_ 保护)
+  mutable std::mutex mtx_;                             // 保护写入与快照
+};
+
+/// @brief 调用计时器: 构造时开始计时, 析构时(包括异常退出)记录到计数器
+class call_timer
+{
+ public:
+  explicit call_timer(symbol_counters *counters) noexcept :
+    counters_(counters), start_(counters ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point())
+  {
+  }
+  call_timer(const call_timer &) = delete;
+  call_timer &operator=(const call_timer &) = delete;
+
+  ~call_timer()
+  {
+    if (!counters_) return;
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_);
+    counters_->record(static_cast<std::uint64_t>(elapsed.count()));
+  }
+
+ private:
+  symbol_counters *counters_;
+  std::chrono::steady_clock::time_point start_;
+};
+#endif  // DLL_ENABLE_INSTRUMENTATION
+
+/// @brief 动态库加载状态, 由 dynamic_library 与其绑定的符号句柄共享
+struct library_state
+{
+  std::atomic<std::uint64_t> generation{0};        // 当前加载代数, 0 表示未加载
+  std::atomic<std::uint64_t> cache_generation{0};  // 符号缓存代数, load 与 clear_cache 时更换(线程本地缓存据此失效)
+#ifdef DLL_ENABLE_INSTRUMENTATION
+  call_profile profile;  // 调用统计, 跨 load/unload 保留
+#endif
+};
+
+/// @brief 延迟加载(load_options::lazy)的参数与状态, 首次使用时由 call_once 串行化加载
+struct lazy_load
+{
+  lazy_load(std::string lib_path, load_flags_t load_flags, bool cache, std::vector<std::string> warmup_symbols) :
+    path(std::move(lib_path)), flags(load_flags), cache_path(cache), warmup(std::move(warmup_symbols))
+  {
+  }
+
+  std::string path;                 // 动态库路径
+  load_flags_t flags;               // 平台原生加载标志
+  bool cache_path;                  // 是否使用库名解析缓存
+  std::vector<std::string> warmup;  // 加载后预热的符号
+  std::once_flag once;              // 保证只加载一次(并发的首次使用只有一个线程执行加载, 其余等待)
+  std::atomic<bool> done{false};    // 加载已尝试(成功或失败), 之后的使用不再进入 call_once
+  std::exception_ptr error;         // 加载失败时的异常, done 之后只读; 之后的使用都报告这个错误
+};
+
+/// @brief 生成全局唯一的加载代数, 每次 load/unload 都会更换, 用于判断符号句柄是否过期
+inline std::uint64_t next_generation() noexcept
+{
+  static std::atomic<std::uint64_t> counter{0};
+  return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+/// @brief 动态库导出表索引: 加载时一次性解析 ELF(.dynsym/.gnu.hash) 或 PE 导出目录, 构建 名称->地址 的扁平哈希表
+///        - 名称直接指向动态库自身的字符串表(零拷贝), 仅在动态库加载期间有效
+///        - 构建后只读, 多线程查找无需加锁
+///        - 只索引动态库自身导出的符号(不包含其依赖库), 查找结果与 dlsym/GetProcAddress 在库自身符号上一致
+class export_index
+{
+  struct slot
+  {
+    std::size_t hash;
+    const char *name;  // nullptr 表示空槽
+    void *address;     // nullptr 表示需要回退到 dlsym/GetProcAddress 解析(如 IFUNC、TLS、转发导出)
+  };
+
+ public:
+  /// @brief 查找结果
+  enum class result
+  {
+    missing,   // 库中没有该导出符号
+    found,     // 找到, 地址有效
+    fallback,  // 存在但地址需要由系统加载器解析
+  };
+
+  /// @brief 解析动态库导出表构建索引, 平台不支持或解析失败返回 false
+  bool build(library_handle handle)
+  {
+    clear();
+    std::vector<slot> exports;
+    if (!collect(handle, exports)) return false;
+    std::size_t capacity = 16;
+    while (capacity < exports.size() * 2) capacity *= 2;  // 负载因子不超过 1/2
+    slots_.assign(capacity, slot{0, nullptr, nullptr});
+    mask_ = capacity - 1;
+    for (const auto &e : exports)
+    {
+      std::size_t i = e.hash & mask_;
+      for (; slots_[i].name != nullptr; i = (i + 1) & mask_)
+      {
+        if (slots_[i].hash == e.hash && std::strcmp(slots_[i].name, e.name) == 0) break;  // 重名只保留第一个
+      }
+      if (slots_[i].name == nullptr)
+      {
+        slots_[i] = e;
+        ++size_;
+      }
+    }
+    ready_ = true;
+    return true;
+  }
+
+  void clear() noexcept
+  {
+    slots_.clear();
+    mask_ = 0;
+    size_ = 0;
+    ready_ = false;
+  }
+
+  /// @brief 索引是否已构建
+  bool ready() const noexcept
+  {
+    return ready_;
+  }
+
+  std::size_t size() const noexcept
+  {
+    return size_;
+  }
+
+  /// @brief 查找符号; 返回 found 时 address 为符号地址
+  result find(const char *name, std::size_t len, void *&address) const noexcept
+  {
+    if (slots_.empty()) return result::missing;
+    const std::size_t h = hash_name(name, len);
+    for (std::size_t i = h & mask_; slots_[i].name != nullptr; i = (i + 1) & mask_)
+    {
+      const slot &e = slots_[i];
+      if (e.hash == h && std::strncmp(e.name, name, len) == 0 && e.name[len] == '\0')
+      {
+        address = e.address;
+        return e.address != nullptr ? result::found : result::fallback;
+      }
+    }
+    return result::missing;
+  }
+
+  /// @brief 枚举所有导出符号名称(按字典序)
+  std::vector<std::string> names() const
+  {
+    std::vector<std::string> out;
+    out.reserve(size_);
+    for (const auto &e : slots_)
+    {
+      if (e.name != nullptr) out.emplace_back(e.name);
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+  }
+
+  friend void swap(export_index &lhs, export_index &rhs) noexcept
+  {
+    using std::swap;
+    swap(lhs.slots_, rhs.slots_);
+    swap(lhs.mask_, rhs.mask_);
+    swap(lhs.size_, rhs.size_);
+    swap(lhs.ready_, rhs.ready_);
+  }
+
+ private:
+  static void add(std::vector<slot> &out, const char *name, void *address)
+  {
+    if (name == nullptr || name[0] == '\0') return;
+    out.push_back(slot{hash_name(name, std::strlen(name)), name, address});
+  }
+
+#if defined(_WIN32) || defined(_WIN64)
+  /// @brief 解析 PE 导出目录
+  static bool collect(library_handle handle, std::vector<slot> &out)
+  {
+    const auto *base = reinterpret_cast<const unsigned char *>(handle);
+    const auto *dos = reinterpret_cast<const IMAGE_DOS_HEADER *>(base);
+    if (dos->e_magic != IMAGE_DOS_SIGNATURE) return false;
+    const auto *nt = reinterpret_cast<const IMAGE_NT_HEADERS *>(base + dos->e_lfanew);
+    if (nt->Signature != IMAGE_NT_SIGNATURE) return false;
+    const IMAGE_DATA_DIRECTORY &dir = nt->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT];
+    if (dir.VirtualAddress == 0 || dir.Size == 0) return true;  // 没有导出表
+    const auto *exp = reinterpret_cast<const IMAGE_EXPORT_DIRECTORY *>(base + dir.VirtualAddress);
+    const auto *names = reinterpret_cast<const DWORD *>(base + exp->AddressOfNames);
+    const auto *ordinals = reinterpret_cast<const WORD *>(base + exp->AddressOfNameOrdinals);
+    const auto *functions = reinterpret_cast<const DWORD *>(base + exp->AddressOfFunctions);
+    out.reserve(exp->NumberOfNames);
+    for (DWORD i = 0; i < exp->NumberOfNames; ++i)
+    {
+      if (ordinals[i] >= exp->NumberOfFunctions) continue;
+      const DWORD rva = functions[ordinals[i]];
+      if (rva == 0) continue;
+      const bool forwarded = rva >= dir.VirtualAddress && rva < dir.VirtualAddress + dir.Size;  // 转发到其他 DLL
+      add(out, reinterpret_cast<const char *>(base + names[i]),
+          forwarded ? nullptr : const_cast<unsigned char *>(base + rva));
+    }
+    return true;
+  }
+#elif defined(__linux__)
+  /// @brief 解析 ELF 动态段中的 .dynsym/.dynstr, 符号数量取自 DT_HASH 或 DT_GNU_HASH
+  static bool collect(library_handle handle, std::vector<slot> &out)
+  {
+    struct link_map *map = nullptr;
+    if (dlinfo(handle, RTLD_DI_LINKMAP, &map) != 0 || map == nullptr || map->l_ld == nullptr) return false;
+    const ElfW(Addr) base = map->l_addr;
+    // glibc 会把动态段中的地址重定位为绝对地址, 其他实现(或只读动态段)可能仍是相对地址
+    auto ptr = [base](ElfW(Addr) addr) { return addr < base ? addr + base : addr; };
+
+    const ElfW(Sym) *symtab = nullptr;
+    const char *strtab = nullptr;
+    const ElfW(Word) *sysv_hash = nullptr;
+    const std::uint32_t *gnu_hash = nullptr;
+    const ElfW(Half) *versym = nullptr;
+    for (const ElfW(Dyn) *d = map->l_ld; d->d_tag != DT_NULL; ++d)
+    {
+      switch (d->d_tag)
+      {
+      case DT_SYMTAB: symtab = reinterpret_cast<const ElfW(Sym) *>(ptr(d->d_un.d_ptr)); break;
+      case DT_STRTAB: strtab = reinterpret_cast<const char *>(ptr(d->d_un.d_ptr)); break;
+      case DT_HASH: sysv_hash = reinterpret_cast<const ElfW(Word) *>(ptr(d->d_un.d_ptr)); break;
+      case DT_GNU_HASH: gnu_hash = reinterpret_cast<const std::uint32_t *>(ptr(d->d_un.d_ptr)); break;
+      case DT_VERSYM: versym = reinterpret_cast<const ElfW(Half) *>(ptr(d->d_un.d_ptr)); break;
+      default: break;
+      }
+    }
+    if (symtab == nullptr || strtab == nullptr) return false;
+
+    std::size_t count = 0;
+    if (sysv_hash != nullptr)
+    {
+      count = sysv_hash[1];  // nchain 等于符号数量
+    }
+    else if (gnu_hash != nullptr)
+    {
+      const std::uint32_t nbuckets = gnu_hash[0];
+      const std::uint32_t symoffset = gnu_hash[1];
+      const std::uint32_t bloom_size = gnu_hash[2];
+      const auto *buckets = reinterpret_cast<const std::uint32_t *>(
+        reinterpret_cast<const ElfW(Addr) *>(gnu_hash + 4) + bloom_size);
+      const std::uint32_t *chain = buckets + nbuckets;
+      std::uint32_t last = 0;
+      for (std::uint32_t i = 0; i < nbuckets; ++i) last = std::max(last, buckets[i]);
+      if (last < symoffset)
+      {
+        count = symoffset;
+      }
+      else
+      {
+        while ((chain[last - symoffset] & 1U) == 0) ++last;  // 链尾标志位
+        count = last + 1;
+      }
+    }
+    else
+    {
+      return false;
+    }
+
+    out.reserve(count);
+    for (std::size_t i = 1; i < count; ++i)
+    {
+      const ElfW(Sym) &sym = symtab[i];
+      if (sym.st_shndx == SHN_UNDEF) continue;  // 引用其他库的符号
+      const unsigned bind = ELF64_ST_BIND(sym.st_info);
+      const unsigned type = ELF64_ST_TYPE(sym.st_info);
+      const unsigned visibility = ELF64_ST_VISIBILITY(sym.st_other);
+      if (bind != STB_GLOBAL && bind != STB_WEAK && bind != STB_GNU_UNIQUE) continue;
+      if (visibility != STV_DEFAULT && visibility != STV_PROTECTED) continue;
+      if (versym != nullptr && (versym[i] & 0x8000U) != 0) continue;  // 非默认版本的符号, dlsym 不会返回它
+      const bool fallback = type == STT_TLS || type == STT_GNU_IFUNC;  // 地址需要加载器计算
+      const bool absolute = sym.st_shndx == SHN_ABS;
+      void *address = fallback ? nullptr : reinterpret_cast<void *>(absolute ? sym.st_value : base + sym.st_value);
+      add(out, strtab + sym.st_name, address);
+    }
+    return true;
+  }
+#else
+  static bool collect(library_handle, std::vector<slot> &)
+  {
+    return false;  // 其他平台(如 macOS 的 Mach-O)暂不支持, 回退到 dlsym
+  }
+#endif
+
+  std::vector<slot> slots_;
+  std::size_t mask_{0};
+  std::size_t size_{0};
+  bool ready_{false};
+};
+
+}  // namespace detail
+
+using detail::library_handle;
+#ifdef DLL_ENABLE_INSTRUMENTATION
+using detail::symbol_stats;
+#endif
+
+class dynamic_library;
+
+/**
+ * @brief 预先解析的函数符号句柄, 由 dynamic_library::bind<F>() 创建
+ *
+ * - 持有原始函数指针, 调用时不再做任何字符串查找
+ * - 记录绑定时动态库的加载代数, 动态库被 unload()/load()/析构后句柄自动失效, 调用过期句柄会抛出异常
+ * - 句柄可拷贝, 跟随动态库对象的移动(移动后的动态库上绑定的句柄仍然有效)
+ *
+ * @tparam F 函数类型, 支持 T(...)、T (*)(...)、T (&)(...)、T (&&)(...)
+ */
+template <typename F>
+class bound_symbol
+{
+  static_assert(std::is_function<detail::remove_ptr_ref_t<F>>::value, "bound_symbol<F> requires a function type");
+
+ public:
+  using pointer = detail::symbol_pointer_t<F>;
+
+  bound_symbol() = default;  // 空句柄, valid() 为 false
+
+  /// @brief 检查句柄是否可用(非空且动态库未被卸载或重新加载)
+  bool valid() const noexcept
+  {
+    return fn_ != nullptr && state_->generation.load(std::memory_order_acquire) == generation_;
+  }
+
+  explicit operator bool() const noexcept
+  {
+    return valid();
+  }
+
+  /// @brief 获取原始函数指针(不做过期检查), 适合对调用开销极端敏感且能自行保证动态库生命周期的场景
+  /// @note 通过原始指针的调用不计入调用统计(DLL_ENABLE_INSTRUMENTATION)
+  pointer get() const noexcept
+  {
+    return fn_;
+  }
+
+  /// @brief 调用函数, 句柄过期时抛出 std::runtime_error
+  template <typename... Args>
+  auto operator()(Args &&...args) const -> decltype(std::declval<pointer>()(std::forward<Args>(args)...))
+  {
+    if (!valid())
+    {
+      throw std::runtime_error("[dynamic_library] error: Bound symbol is empty or its library was unloaded/reloaded");
+    }
+#ifdef DLL_ENABLE_INSTRUMENTATION
+    detail::call_timer timer(counters_);
+#endif
+    return fn_(std::forward<Args>(args)...);
+  }
+
+ private:
+  friend class dynamic_library;
+  bound_symbol(pointer fn, std::shared_ptr<const detail::library_state> state, std::uint64_t generation) noexcept :
+    fn_(fn), state_(std::move(state)), generation_(generation)
+  {
+  }
+
+  pointer fn_{nullptr};                                 // 原始函数指针
+  std::shared_ptr<const detail::library_state> state_;  // 动态库加载状态
+  std::uint64_t generation_{0};                         // 绑定时的加载代数
+#ifdef DLL_ENABLE_INSTRUMENTATION
+  detail::symbol_counters *counters_{nullptr};  // 调用统计(随 state_ 存活)
+#endif
+};
+
+/// @brief 加载器跟踪事件类型
+enum class trace_event_type
+{
+  load,       // dlopen/LoadLibrary 完成(成功或失败)
+  unload,     // dlclose/FreeLibrary 完成
+  cache_hit,  // 符号命中缓存(包括已知不存在的否定项)
+  resolve,    // 符号未命中缓存, 经导出表索引或 dlsym/GetProcAddress 解析
+};
+
+/**
+ * @brief 加载器跟踪事件, 只在回调执行期间有效(指针成员不要保存到回调之外)
+ *
+ * - load: duration_ns 为 dlopen/LoadLibrary 的耗时, 其中包括映射、重定位以及静态初始化(全局构造函数/DllMain),
+ *   系统加载器不单独报告静态初始化耗时
+ * - unload: duration_ns 为 dlclose/FreeLibrary 的耗时(包括全局析构函数)
+ * - cache_hit/resolve: duration_ns 为查找耗时, symbol 为符号名称(不保证以 '\0' 结尾, 以 symbol_len 为准)
+ */
+struct trace_event
+{
+  trace_event_type type;      // 事件类型
+  const char *path;           // 动态库路径
+  const char *symbol;         // 符号名称, load/unload 事件为 nullptr
+  std::size_t symbol_len;     // 符号名称长度
+  std::uint64_t duration_ns;  // 耗时(纳秒)
+  bool success;               // load: 是否加载成功; cache_hit/resolve: 符号是否存在; unload: 总为 true
+};
+
+/// @brief 跟踪回调, 在触发事件的线程上同步调用; 回调不能抛出异常, 应尽量轻量(或只把事件写入队列),
+///        也不要在回调中调用 dlopen/dlsym 等加载器函数(会覆盖随后异常信息中的错误原因)
+using trace_callback = void (*)(const trace_event &event, void *user_data);
+
+namespace detail
+{
+/// @brief 全局跟踪回调及其用户数据, 作为一个整体原子发布
+struct trace_sink
+{
+  trace_callback callback;
+  void *user_data;
+};
+
+inline std::atomic<const trace_sink *> &trace_sink_slot() noexcept
+{
+  static std::atomic<const trace_sink *> slot{nullptr};
+  return slot;
+}
+
+/// @brief 当前跟踪回调, 未设置时返回 nullptr(调用路径上只有这一次原子读取)
+inline const trace_sink *current_trace_sink() noexcept
+{
+  return trace_sink_slot().load(std::memory_order_acquire);
+}
+
+inline std::uint64_t trace_now_ns() noexcept
+{
+  return static_cast<std::uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+inline void emit_trace(const trace_sink *sink, trace_event_type type, const std::string &path, const char *symbol,
+                       std::size_t symbol_len, std::uint64_t start_ns, bool success) noexcept
+{
+  const trace_event event{type, path.c_str(), symbol, symbol_len, trace_now_ns() - start_ns, success};
+  sink->callback(event, sink->user_data);
+}
+}  // namespace detail
+
+/**
+ * @brief 设置进程级加载器跟踪回调, 传入 nullptr 关闭跟踪
+ * @param callback 回调函数, 所有 dynamic_library 对象的 load/unload/符号查找事件都会回调
+ * @param user_data 原样传给回调的用户数据
+ *
+ * @note 线程安全. 发布过的回调(包括被替换的旧回调)有意不释放: 正在执行旧回调的线程不受影响, 静态析构阶段
+ *       卸载的动态库(如全局 dynamic_library 对象)也仍能安全读取; 每次设置泄漏一个很小的对象, 不建议高频切换
+ */
+inline void set_trace_callback(trace_callback callback, void *user_data = nullptr)
+{
+  static std::mutex &mtx = *new std::mutex;  // 同样不析构, 静态析构期间仍可调用
+  std::lock_guard<std::mutex> lock(mtx);
+  const detail::trace_sink *sink = callback ? new detail::trace_sink{callback, user_data} : nullptr;
+  detail::trace_sink_slot().store(sink, std::memory_order_release);
+}
+
+/// @brief 符号缓存模式
+enum class cache_mode
+{
+  locked,             // 默认: 互斥锁保护的缓存表, 命中与未命中都需要加锁
+  lock_free,          // 无锁读: 命中不加锁且 wait-free, 只有未命中插入和 clear_cache()/unload() 才加锁写
+  thread_local_tier,  // 线程本地缓存 + 无锁共享缓存: 热点符号命中不访问任何线程间共享的缓存行(只读取缓存代数)
+};
+
+/**
+ * @brief 动态库加载选项
+ *
+ *   dll::load_options opts;
+ *   opts.flags = RTLD_NOW | RTLD_LOCAL;          // POSIX: 立即绑定, 首次调用不再触发 PLT 解析
+ *   opts.warmup = {"intAdd", "doubleAdd"};       // 加载后立即解析并缓存
+ *   dll::dynamic_library lib("libfoo.so", opts);
+ */
+struct load_options
+{
+  /// 平台原生加载标志:
+  /// - POSIX: dlopen 的 mode, 如 RTLD_LAZY/RTLD_NOW、RTLD_LOCAL/RTLD_GLOBAL、RTLD_NODELETE、RTLD_DEEPBIND(glibc)
+  /// - Windows: LoadLibraryEx 的 dwFlags, 如 LOAD_LIBRARY_SEARCH_DEFAULT_DIRS、LOAD_WITH_ALTERED_SEARCH_PATH
+  detail::load_flags_t flags = detail::default_load_flags;
+  cache_mode cache = cache_mode::locked;  // 符号缓存模式
+  bool export_index = false;              // 是否在加载时构建导出表索引
+  std::vector<std::string> warmup;        // 加载后立即解析并缓存的符号(预热), 不存在的符号记为否定缓存
+  bool lazy = false;  // 延迟加载: 构造/load() 只记录路径与选项, 首次 get/invoke/has_symbol 等使用时才加载(线程安全)
+  /// Windows: flags 中没有 LOAD_LIBRARY_SEARCH_* 时加上 LOAD_LIBRARY_SEARCH_DLL_LOAD_DIR | DEFAULT_DIRS,
+  /// 只在动态库所在目录、应用目录、System32 和 AddDllDirectory 添加的目录中搜索(含依赖库); POSIX 无影响
+  bool restrict_search = false;
+  /// 不含目录的库名第一次加载后记录解析到的完整路径, 之后按同一库名加载时跳过搜索(默认关闭, 需要时显式开启);
+  /// 搜索目录变化后缓存的路径可能已过时, 需调用 dll::clear_path_cache()
+  bool cache_path = false;
+};
+
+/// @brief 清空库名解析缓存(修改了 PATH、AddDllDirectory 或移动了动态库之后调用)
+inline void clear_path_cache()
+{
+  detail::path_cache::instance().clear();
+}
+
+/// @brief 插件描述符中一个参与 ABI 的结构体布局(与插件端 C 结构体布局相同)
+struct plugin_layout
+{
+  const char *name;     // 结构体名称, 按名称与宿主端期望的布局匹配
+  std::uint32_t size;   // sizeof
+  std::uint32_t align;  // alignof
+};
+
+/**
+ * @brief 插件描述符的公共头部, 必须是描述符结构体的第一个成员
+ *
+ * 插件导出一个返回静态描述符指针的入口函数, 描述符 = plugin_abi 头部 + 版本相关的函数指针;
+ * 兼容的新版本只在末尾追加成员(descriptor_size 随之增大), 不兼容的修改必须增加 abi_version
+ */
+struct plugin_abi
+{
+  std::uint32_t abi_version;      // 描述符 ABI 版本, 必须与宿主完全一致
+  std::uint32_t descriptor_size;  // 插件端描述符大小, 不小于宿主端结构体大小才能安全访问所有成员
+  std::uint64_t features;         // 功能位(含义由插件接口定义)
+  std::uint32_t layout_count;     // layouts 数组长度
+  const plugin_layout *layouts;   // 插件编译时的结构体布局
+};
+
+/// @brief 生成宿主端期望的结构体布局, 用于 load_descriptor() 的校验, 如 DLL_PLUGIN_LAYOUT(point_t)
+#define DLL_PLUGIN_LAYOUT(T) ::dll::plugin_layout{#T, sizeof(T), alignof(T)}
+
+/// @brief 动态库加载类, 使用 RAII 管理动态库资源
+class dynamic_library
+{
+  template <typename T>
+  using symbol_pointer_t = typename detail::symbol_pointer_t<T>;
+  using name_ref = detail::name_ref;  // 符号名称参数, 接收 const char*、std::string、std::string_view
+
+ public:
+  dynamic_library() = default;  // 默认构造函数, handle_为nullptr
+
+  /**
+   * @brief 构造函数, 加载指定路径的动态库
+   * @param libPath 动态库路径
+   * @throw std::runtime_error 如果加载失败, 则抛出异常
+   */
+  explicit dynamic_library(const std::string &libPath)
+  {
+    load_handle(libPath);
+  }
+
+  /**
+   * @brief 构造函数, 加载指定路径的动态库并指定符号缓存模式
+   * @param libPath 动态库路径
+   * @param mode 符号缓存模式, 多线程高频调用 invoke() 时推荐 cache_mode::lock_free
+   * @throw std::runtime_error 如果加载失败, 则抛出异常
+   */
+  dynamic_library(const std::string &libPath, cache_mode mode) : mode_(mode)
+  {
+    load_handle(libPath);
+  }
+
+  /**
+   * @brief 构造函数, 按加载选项加载指定路径的动态库
+   * @param libPath 动态库路径
+   * @param options 加载选项(加载标志、缓存模式、导出表索引、预热符号、延迟加载)
+   * @throw std::runtime_error 如果加载失败, 则抛出异常(延迟加载时在首次使用时抛出)
+   */
+  dynamic_library(const std::string &libPath, const load_options &options) :
+    mode_(options.cache), index_enabled_(options.export_index)
+  {
+    open(libPath, options);
+  }
+
+  /// @brief 析构函数 - 自动卸载动态库
+  ~dynamic_library()
+  {
+    unload_handle();
+  }
+
+  // 禁用拷贝语义, 防止拷贝可能导致的资源管理问题
+  dynamic_library(const dynamic_library &) = delete;
+  dynamic_library &operator=(const dynamic_library &) = delete;
+
+  // 支持移动语义, 便于资源的安全转移 - 移动构造
+  dynamic_library(dynamic_library &&other) noexcept :
+    handle_(other.handle_),
+    path_(std::move(other.path_)),
+    temp_file_(std::move(other.temp_file_)),
+    lazy_(std::move(other.lazy_)),
+    mode_(other.mode_),
+    index_enabled_(other.index_enabled_),
+    state_(std::move(other.state_))
+  {
+    swap(cache_, other.cache_);
+    swap(index_, other.index_);
+    other.handle_ = nullptr;
+  }
+
+  // 支持移动语义, 便于资源的安全转移 - 移动赋值
+  dynamic_library &operator=(dynamic_library &&rhs) noexcept
+  {
+    // 常规实现方式
+    // if (this != &rhs)
+    // {
+    //   if (handle_)  // 卸载自身句柄
+    //   {
+    //     detail::unload_library(handle_);
+    //   }
+    //   handle_ = rhs.handle_;
+    //   cache_ = std::move(rhs.cache_);
+    //   rhs.handle_ = nullptr;
+    //   rhs.cache_.clear();
+    // }
+
+    // move-and-swap方式(自赋值安全, 异常安全)
+    dynamic_library tmp(std::move(rhs));  // tmp 用移动构造拿走 rhs 的资源
+    swap(*this, tmp);                     // 当前对象和 tmp 交换, tmp 拿到旧资源
+    return *this;                         // tmp 析构, 释放旧资源
+  }
+
+  // swap 函数：强异常安全, 供移动赋值使用
+  friend void swap(dynamic_library &lhs, dynamic_library &rhs) noexcept
+  {
+    using std::swap;
+    swap(lhs.handle_, rhs.handle_);
+    swap(lhs.path_, rhs.path_);
+    swap(lhs.temp_file_, rhs.temp_file_);
+    swap(lhs.lazy_, rhs.lazy_);
+    swap(lhs.mode_, rhs.mode_);
+    swap(lhs.index_enabled_, rhs.index_enabled_);
+    swap(lhs.state_, rhs.state_);
+    swap(lhs.cache_, rhs.cache_);
+    swap(lhs.index_, rhs.index_);
+  }
+
+  /// @brief 检查动态库是否已加载
+  explicit operator bool() const noexcept
+  {
+    return valid();
+  }
+
+  /// @brief 检查动态库中是否存在指定符号, 如果符号存在 返回 true 否则返回 false
+  /// @note 查找结果(包括不存在)会被缓存, 重复查询只需一次进程内哈希探测; load()/unload() 时缓存失效
+  bool has_symbol(const name_ref &name) const noexcept
+  {
+    return lookup(name) != nullptr;
+  }
+
+  /**
+   * @brief 加载动态库中的符号(函数或变量), 加载失败抛出异常
+   *
+   * @tparam F 要获取的符号类型, 可以是函数类型(如 int(int, int))或变量指针类型(如 int*、const char**)
+   * @param symbol_name 符号名称(区分大小写)
+   * @return 符号地址, 类型为 symbol_pointer_t<F>
+   * @throw std::runtime_error 加载失败时抛出异常, 包含符号名和错误信息
+   *
+   * @note 获取变量推荐使用 get_variable<T>()
+   */
+  template <typename F>
+  symbol_pointer_t<F> get(const name_ref &symbol_name) const
+  {
+    require_lazy();
+    if (!handle_)
+    {
+      throw std::runtime_error("[dynamic_library] error: Dynamic library not loaded");
+    }
+    bool cached = false;
+    auto symbol = reinterpret_cast<symbol_pointer_t<F>>(lookup(symbol_name, &cached));
+    if (!symbol)
+    {
+      throw std::runtime_error(detail::format_error("Failed to load symbol", symbol_name.c_str(), symbol_name.size(),
+                                                    lookup_error(symbol_name, cached)));
+    }
+    return symbol;
+  }
+
+  /**
+   * @brief 尝试加载动态库中的符号(函数或变量), 失败返回 nullptr(不会抛出异常)
+   *
+   * @tparam F 符号类型(函数或变量指针类型)
+   * @param symbol_name 符号名称(区分大小写)
+   * @return 成功返回符号地址, 失败返回 nullptr
+   *
+   * @note 获取变量推荐使用 try_get_variable<T>(); 查找结果(包括不存在)会被缓存
+   */
+  template <typename F>
+  symbol_pointer_t<F> try_get(const name_ref &symbol_name) const noexcept
+  {
+    return reinterpret_cast<symbol_pointer_t<F>>(lookup(symbol_name));
+  }
+
+  /**
+   * @brief 加载动态库中的变量, 失败抛出异常
+   *
+   * @tparam T 变量的基础类型，如 int、double、const char*、MyStruct 等(非函数类型)
+   * @param variable_name 变量符号名称(区分大小写)
+   * @return 返回变量的引用
+   * @throw std::runtime_error 加载失败抛出异常
+   */
+  template <typename T, typename std::enable_if<!std::is_function<detail::remove_ptr_ref_t<T>>::value, int>::type = 0>
+  T &get_variable(const name_ref &variable_name) const
+  {
+    require_lazy();
+    bool cached = false;
+    T *var_ptr = reinterpret_cast<T *>(lookup(variable_name, &cached));
+    if (!var_ptr)
+    {
+      throw std::runtime_error(detail::format_error("Failed to load variable", variable_name.c_str(),
+                                                    variable_name.size(), lookup_error(variable_name, cached)));
+    }
+    return *var_ptr;
+  }
+
+  /**
+   * @brief 尝试加载动态库中的变量, 成功返回变量地址, 失败返回 nullptr(不会抛出异常)
+   *
+   * @tparam T 变量的基础类型，如 int、double、const char*、MyStruct 等(非函数类型)
+   * @param variable_name 变量符号名称(区分大小写)
+   * @return 返回变量指针, 加载失败返回 nullptr
+   */
+  template <typename T, typename std::enable_if<!std::is_function<detail::remove_ptr_ref_t<T>>::value, int>::type = 0>
+  T *try_get_variable(const name_ref &variable_name) const noexcept
+  {
+    return try_get<T *>(variable_name);
+  }
+
+  /**
+   * @brief 一次性加载整张符号表(由 DLL_SYMBOL_TABLE 定义的函数指针结构体), 失败抛出异常
+   *
+   * @tparam Table 符号表类型
+   * @return 填充完毕的符号表, 之后直接通过结构体成员调用, 不再查找符号
+   * @throw std::runtime_error 动态库未加载或有符号缺失时抛出异常, 异常信息中一次性列出所有缺失的符号
+   */
+  template <typename Table>
+  Table load_table() const
+  {
+    require_lazy();
+    if (!handle_)
+    {
+      throw std::runtime_error("[dynamic_library] error: Dynamic library not loaded");
+    }
+    Table table;
+    std::string missing;
+    if (!try_load_table(table, &missing))
+    {
+      throw std::runtime_error("[dynamic_library] error: Failed to load symbol table, missing symbols: " + missing);
+    }
+    return table;
+  }
+
+  /**
+   * @brief 尝试一次性加载整张符号表, 不会抛出异常
+   *
+   * @tparam Table 符号表类型(由 DLL_SYMBOL_TABLE 定义)
+   * @param table 输出的符号表, 缺失的符号对应成员为 nullptr
+   * @param missing 可选, 输出缺失的符号名称列表(形如 'a', 'b')
+   * @return 所有符号都加载成功返回 true, 否则返回 false
+   */
+  template <typename Table>
+  bool try_load_table(Table &table, std::string *missing = nullptr) const
+  {
+    table_loader loader{this, missing, true};
+    table.dll_visit_symbols(loader);
+    return loader.ok;
+  }
+
+  /**
+   * @brief 通过单个入口函数获取插件描述符(静态函数指针表), 并在使用前校验 ABI
+   *
+   *   struct plugin_api { dll::plugin_abi abi; int (*intAdd)(int, int); };
+   *   const auto &api = lib.load_descriptor<plugin_api>(1, {DLL_PLUGIN_LAYOUT(point_t)});
+   *   api.intAdd(1, 2);  // 直接通过函数指针调用, 不再查找符号
+   *
+   * @tparam Descriptor 描述符类型, 标准布局且第一个成员为 plugin_abi
+   * @param abi_version 宿主期望的 ABI 版本(必须完全一致)
+   * @param layouts 宿主期望的结构体布局, 每一项都必须在插件描述符中存在且大小、对齐相同
+   * @param entry 入口函数名称, 签名为 const Descriptor *()
+   * @return 插件描述符的引用, 在动态库卸载前有效
+   * @throw std::runtime_error 入口不存在、返回空指针或校验失败时抛出异常, 异常信息中一次性列出所有不匹配项
+   */
+  template <typename Descriptor>
+  const Descriptor &load_descriptor(std::uint32_t abi_version, std::initializer_list<plugin_layout> layouts = {},
+                                    const name_ref &entry = "get_plugin_descriptor") const
+  {
+    static_assert(std::is_standard_layout<Descriptor>::value, "Descriptor must be a standard-layout type");
+    auto get_descriptor = get<const Descriptor *()>(entry);
+    const Descriptor *descriptor = get_descriptor();
+    std::string reason;
+    if (!descriptor)
+    {
+      reason = "returned a null descriptor";
+    }
+    else
+    {
+      reason = check_plugin_abi(reinterpret_cast<const plugin_abi &>(*descriptor), abi_version,
+                                static_cast<std::uint32_t>(sizeof(Descriptor)), layouts);
+    }
+    if (!reason.empty())
+    {
+      throw std::runtime_error(
+        detail::format_error("Incompatible plugin descriptor", entry.c_str(), entry.size(), reason));
+    }
+    return *descriptor;
+  }
+
+  /**
+   * @brief 调用动态库中的符号, 支持参数转发(调用后会缓存函数)
+   *
+   * @tparam F 函数指针类型, 用于指定要调用的符号对应的函数类型
+   * @tparam Args 可变参数模板, 用于指定传递给函数的参数类型
+   * @param symbol_name 符号名称, 指定要调用的符号的名称
+   * @param args 可变参数, 完美转发给函数(按值传递的形参直接由实参构造, 大结构体不会先复制一份到 invoke 中)
+   * @return 返回函数调用的结果
+   * @throw `std::runtime_error` 如果加载符号失败, 则抛出异常
+   *
+   * @note 该函数会尝试加载并调用动态库中的指定符号.如果符号不存在或加载失败,
+   *       会抛出 `std::runtime_error` 异常.使用此函数时需确保符号名称正确.
+   */
+  template <typename F, typename... Args>
+  auto invoke(const name_ref &symbol_name, Args &&...args) const
+    -> decltype(std::declval<symbol_pointer_t<F>>()(std::forward<Args>(args)...))
+  {
+    auto symbol = get<F>(symbol_name);  // 先查缓存, 未命中时加载并缓存, 加载失败抛异常
+#ifdef DLL_ENABLE_INSTRUMENTATION
+    detail::call_timer timer(state_->profile.counters(symbol_name.c_str(), symbol_name.size()));
+#endif
+    return symbol(std::forward<Args>(args)...);  // 调用函数
+  }
+
+  /**
+   * @brief 绑定动态库中的函数符号, 返回可直接调用的句柄(只解析一次, 之后调用不再查找字符串)
+   *
+   * @tparam F 函数类型, 如 int(int, int)
+   * @param symbol_name 符号名称(区分大小写)
+   * @return 函数句柄, 动态库卸载或重新加载后句柄失效(valid() 返回 false, 调用抛异常)
+   * @throw std::runtime_error 加载失败时抛出异常
+   */
+  template <typename F>
+  bound_symbol<F> bind(const name_ref &symbol_name) const
+  {
+    auto fn = get<F>(symbol_name);
+    return make_bound<F>(fn, symbol_name);
+  }
+
+  /**
+   * @brief 尝试绑定动态库中的函数符号, 失败返回空句柄(不会抛出异常)
+   *
+   * @tparam F 函数类型, 如 int(int, int)
+   * @param symbol_name 符号名称(区分大小写)
+   * @return 函数句柄, 加载失败时 valid() 返回 false
+   */
+  template <typename F>
+  bound_symbol<F> try_bind(const name_ref &symbol_name) const noexcept
+  {
+    auto fn = try_get<F>(symbol_name);
+    if (!fn) return bound_symbol<F>();
+    return make_bound<F>(fn, symbol_name);
+  }
+
+  /**
+   * @brief 调用动态库中的符号, 支持参数转发(不使用缓存)
+   *
+   * @tparam F 函数指针类型, 用于指定要调用的符号对应的函数类型
+   * @tparam Args 可变参数模板, 用于指定传递给函数的参数类型
+   * @param symbol_name 符号名称, 指定要调用的符号的名称
+   * @param args 可变参数, 完美转发给函数(按值传递的形参直接由实参构造, 大结构体不会先复制一份到 invoke 中)
+   * @return 返回函数调用的结果
+   * @throw `std::runtime_error` 如果加载符号失败, 则抛出异常
+   *
+   * @note 该函数会尝试加载并调用动态库中的指定符号.如果符号不存在或加载失败,
+   *       会抛出 `std::runtime_error` 异常.使用此函数时需确保符号名称正确.
+   */
+  template <typename F, typename... Args>
+  auto invoke_uncached(const name_ref &symbol_name, Args &&...args) const
+    -> decltype(std::declval<symbol_pointer_t<F>>()(std::forward<Args>(args)...))
+  {
+    require_lazy();
+    auto symbol = reinterpret_cast<symbol_pointer_t<F>>(resolve(symbol_name));  // 绕过缓存
+    if (!symbol)
+    {
+      throw std::runtime_error(detail::format_error("Failed to load symbol", symbol_name.c_str(), symbol_name.size(),
+                                                    lookup_error(symbol_name)));
+    }
+#ifdef DLL_ENABLE_INSTRUMENTATION
+    detail::call_timer timer(state_->profile.counters(symbol_name.c_str(), symbol_name.size()));
+#endif
+    return symbol(std::forward<Args>(args)...);  // 直接调用函数
   }
 
   /// @brief 检查动态库是否已加载
-  /// @return 如果已加载, 返回 true; 否则返回 false
+  /// @return 如果已加载, 返回 true; 否则返回 false(延迟加载且尚未使用时也返回 false, 不会触发加载)
   bool valid() const noexcept
   {
+    if (lazy_) return lazy_->done.load(std::memory_order_acquire) && !lazy_->error;
     return handle_ != nullptr;
   }
 
+  /// @brief 是否为延迟加载且尚未加载(还没有任何使用触发加载)
+  bool pending() const noexcept
+  {
+    return lazy_ && !lazy_->done.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief 延迟加载时立即加载(例如在空闲时提前触发), 已加载时什么也不做
+   * @throw std::runtime_error 动态库未加载(从未指定路径或已卸载)或延迟加载失败时抛出异常
+   */
+  void ensure_loaded() const
+  {
+    require_lazy();
+    if (!handle_)
+    {
+      throw std::runtime_error("[dynamic_library] error: Dynamic library not loaded");
+    }
+  }
+
   /// @brief 加载动态库, 加载失败抛出异常`std::runtime_error`
   /// @param libPath 动态库路径
   void load(const std::string &libPath)
@@ -382,6 +1957,114 @@ class dynamic_library
     load_handle(libPath);
   }
 
+  /// @brief 按加载选项加载动态库, 加载失败抛出异常`std::runtime_error`
+  /// @param libPath 动态库路径
+  /// @param options 加载选项, 其中的缓存模式与导出表索引设置会替换当前设置
+  void load(const std::string &libPath, const load_options &options)
+  {
+    unload();
+    mode_ = options.cache;
+    index_enabled_ = options.export_index;
+    open(libPath, options);
+  }
+
+  /**
+   * @brief 从内存中的动态库映像加载(如从制品仓库下载的插件), 不需要调用者先写入磁盘再加载
+   *
+   * - Linux 使用 memfd_create + /proc/self/fd/N, 映像只存在于内存中;
+   *   其他平台写入临时文件后加载(见 detail::memory_image)
+   * - 加载后 path() 返回 "memory:<name>"; 同一映像多次加载得到相互独立的动态库实例
+   *
+   * @param data 映像数据(完整的 .so/.dll 文件内容), 加载完成后调用者即可释放
+   * @param size 映像字节数
+   * @param options 加载选项, 其中的缓存模式与导出表索引设置会替换当前设置(lazy 被忽略, 映像总是立即加载)
+   * @param name 映像名称, 用于 path()、错误信息、跟踪事件以及 /proc/<pid>/maps 中的 memfd 名称
+   * @throw std::runtime_error 映像写入或加载失败时抛出异常
+   */
+  void load_from_memory(const void *data, std::size_t size, const load_options &options = load_options(),
+                        const std::string &name = "image")
+  {
+    unload();
+    mode_ = options.cache;
+    index_enabled_ = options.export_index;
+    detail::memory_image image(data, size, name);
+    load_handle(image.path(), native_flags(options), "memory:" + name);
+    temp_file_ = image.release();  // Windows: 文件在卸载后才能删除
+    warm_up(options.warmup);
+  }
+
+#ifdef DYNAMIC_LIBRARY_HAS_SPAN
+  /// @brief 从内存中的动态库映像加载(C++20 std::span 版本)
+  void load_from_memory(std::span<const std::byte> image, const load_options &options = load_options(),
+                        const std::string &name = "image")
+  {
+    load_from_memory(image.data(), image.size(), options, name);
+  }
+#endif
+
+  /**
+   * @brief 预热符号: 立即解析并缓存给定的符号, 把查找开销提前到启动阶段
+   *
+   * 先在锁外解析所有尚未缓存的符号, 再一次加锁批量写入缓存, 可以在其他线程使用动态库的同时调用
+   *
+   * @param symbols 符号名称列表
+   * @return 不存在的符号数量(这些符号记为否定缓存)
+   */
+  std::size_t warm_up(const std::vector<std::string> &symbols) const noexcept
+  {
+    if (!opened()) return symbols.size();
+    std::size_t missing = 0;
+    std::vector<std::pair<const std::string *, void *>> resolved;
+    try
+    {
+      resolved.reserve(symbols.size());
+    }
+    catch (...)
+    {
+      // 内存不足时退化为逐个查找
+      for (const auto &name : symbols) missing += lookup(name) == nullptr ? 1 : 0;
+      return missing;
+    }
+    for (const auto &name : symbols)
+    {
+      void *sym = nullptr;
+      if (find_cache(name, sym))
+      {
+        missing += sym == nullptr ? 1 : 0;
+        continue;
+      }
+      sym = resolve(name);
+      missing += sym == nullptr ? 1 : 0;
+      resolved.emplace_back(&name, sym);
+    }
+    std::lock_guard<std::mutex> lock(mtx_);
+    for (const auto &r : resolved)
+    {
+      try
+      {
+        cache_.insert(r.first->data(), r.first->size(), r.second);
+      }
+      catch (...)
+      {
+        break;  // 缓存只是优化, 内存不足时放弃剩余的缓存
+      }
+    }
+    return missing;
+  }
+
+  /// @brief 当前缓存中已解析成功的符号名称(不含否定项), 可用于记录进程实际使用的符号(见 symbol_manifest.hpp)
+  std::vector<std::string> cached_symbols() const
+  {
+    std::vector<std::string> names;
+    std::lock_guard<std::mutex> lock(mtx_);
+    names.reserve(cache_.size());
+    cache_.for_each([&names](const char *name, std::size_t len, void *value) {
+      if (value != nullptr) names.emplace_back(name, len);
+    });
+    std::sort(names.begin(), names.end());
+    return names;
+  }
+
   /// @brief 显式释放动态库资源(提前释放)
   void unload() noexcept
   {
@@ -389,6 +2072,110 @@ class dynamic_library
     clear_cache();
   }
 
+  /// @brief 获取当前符号缓存模式
+  cache_mode get_cache_mode() const noexcept
+  {
+    return mode_;
+  }
+
+  /// @brief 切换符号缓存模式(会清空已有缓存)
+  /// @note 非线程安全, 请在对象被多线程共享之前调用
+  void set_cache_mode(cache_mode mode) noexcept
+  {
+    clear_cache();
+    mode_ = mode;
+  }
+
+  /// @brief 符号缓存中的项数(含否定项)
+  std::size_t cache_size() const noexcept
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return cache_.size();
+  }
+
+  /// @brief 符号缓存占用的堆内存字节数; 缓存项与名称存放在同一个内存池中, clear_cache()/unload() 时整体释放
+  std::size_t cache_memory_usage() const noexcept
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return cache_.memory_usage();
+  }
+
+  /**
+   * @brief 启用/关闭导出表索引: 加载时一次性解析动态库导出表(ELF .dynsym/.gnu.hash 或 PE 导出目录)
+   *
+   * @param enable true 启用(已加载时立即构建, 之后每次 load() 都会重建), false 关闭并释放索引
+   * @return 索引是否可用; 平台不支持(如 macOS)时返回 false, 查找自动回退到 dlsym/GetProcAddress
+   *
+   * @note 启用后 get/try_get/has_symbol/invoke 只在动态库自身的导出符号中查找(不再搜索其依赖库),
+   *       不存在的符号直接返回, 不再经过系统加载器. 非线程安全, 请在对象被多线程共享之前调用
+   */
+  bool enable_export_index(bool enable = true)
+  {
+    index_enabled_ = enable;
+    clear_cache();  // 查找范围发生变化, 已缓存的结果(尤其是否定项)不再可靠
+    index_.clear();
+    if (enable && handle_ != nullptr) index_.build(handle_);
+    return index_.ready();
+  }
+
+  /// @brief 导出表索引是否可用
+  bool has_export_index() const noexcept
+  {
+    return index_.ready();
+  }
+
+  /// @brief 枚举动态库自身导出的所有符号名称(按字典序); 平台不支持或未加载时返回空
+  std::vector<std::string> exports() const
+  {
+    if (index_.ready()) return index_.names();
+    detail::export_index tmp;
+    if (!opened() || !tmp.build(handle_)) return {};
+    return tmp.names();
+  }
+
+#ifdef DLL_ENABLE_INSTRUMENTATION
+  /**
+   * @brief 调用统计快照(需定义 DLL_ENABLE_INSTRUMENTATION): invoke()/invoke_uncached()/bound_symbol 的
+   *        每符号调用次数、累计/最大耗时和 log2 延迟直方图, 按累计耗时从高到低排序
+   * @note 统计跨 load()/unload() 保留, 直到对象析构或 reset_call_stats()
+   */
+  std::vector<symbol_stats> call_stats() const
+  {
+    if (!state_) return {};
+    return state_->profile.snapshot();
+  }
+
+  /// @brief 清零调用统计
+  void reset_call_stats() noexcept
+  {
+    if (state_) state_->profile.reset();
+  }
+
+  /// @brief 以文本表格导出调用统计, 每个符号一行
+  std::string call_stats_report() const
+  {
+    char line[256];
+    std::snprintf(line, sizeof(line), "%-32s %10s %14s %11s %9s %10s\n", "symbol", "calls", "total(us)", "mean(ns)",
+                  "p99(ns)", "max(ns)");
+    std::string report = line;
+    for (const auto &st : call_stats())
+    {
+      std::snprintf(line, sizeof(line), "%-32s %10llu %14.1f %11.1f %9llu %10llu\n", st.name.c_str(),
+                    static_cast<unsigned long long>(st.calls), static_cast<double>(st.total_ns) / 1000.0,
+                    st.mean_ns(), static_cast<unsigned long long>(st.percentile_ns(0.99)),
+                    static_cast<unsigned long long>(st.max_ns));
+      report += line;
+    }
+    return report;
+  }
+#endif
+
+  /// @brief 当前加载的动态库路径(构造或 load() 时传入的路径), 未加载时返回空字符串; 延迟加载时返回待加载的路径
+  const std::string &path() const noexcept
+  {
+    return lazy_ ? lazy_->path : path_;
+  }
+
   /// @brief 获取动态库底层原生句柄 (Windows 的 `HMODULE` 或 POSIX 的 `void*`)
   /// @return 底层原生句柄
   /// @note
@@ -396,45 +2183,382 @@ class dynamic_library
   ///   避免在销毁前手动释放或操作句柄.不正确的手动操作句柄可能导致资源泄露或不正确的资源管理(破坏RAII机制).
   library_handle native_handle() const noexcept
   {
-    return handle_;
+    return opened() ? handle_ : nullptr;  // 延迟加载时会触发加载
   }
 
  private:
+  /// @brief 符号表加载器, 依次填充符号表中的每个成员并收集缺失的符号
+  struct table_loader
+  {
+    const dynamic_library *lib;
+    std::string *missing;
+    bool ok;
+
+    template <typename P>
+    void operator()(const char *name, P &slot)
+    {
+      slot = reinterpret_cast<P>(lib->resolve(name));
+      if (slot) return;
+      if (missing)
+      {
+        if (!ok) missing->append(", ");
+        missing->append(1, '\'').append(name).append(1, '\'');
+      }
+      ok = false;
+    }
+  };
+
+  /// @brief 校验插件描述符头部, 返回所有不匹配项的说明(全部匹配时返回空字符串)
+  static std::string check_plugin_abi(const plugin_abi &abi, std::uint32_t abi_version, std::uint32_t min_size,
+                                      std::initializer_list<plugin_layout> expected)
+  {
+    std::string reason;
+    auto mismatch = [&reason](const std::string &what) {
+      reason.append(reason.empty() ? "" : "; ").append(what);
+    };
+    if (abi.abi_version != abi_version)
+    {
+      mismatch("ABI version " + std::to_string(abi.abi_version) + ", expected " + std::to_string(abi_version));
+      return reason;  // 版本不同时其余字段的含义也可能不同, 不再继续检查
+    }
+    if (abi.descriptor_size < min_size)
+    {
+      mismatch("descriptor size " + std::to_string(abi.descriptor_size) + ", expected at least " +
+               std::to_string(min_size));
+    }
+    for (const plugin_layout &want : expected)
+    {
+      const plugin_layout *found = nullptr;
+      for (std::uint32_t i = 0; i < abi.layout_count && abi.layouts; ++i)
+      {
+        if (abi.layouts[i].name && std::strcmp(abi.layouts[i].name, want.name) == 0)
+        {
+          found = &abi.layouts[i];
+          break;
+        }
+      }
+      if (!found)
+      {
+        mismatch(std::string("layout of '") + want.name + "' not exported");
+      }
+      else if (found->size != want.size || found->align != want.align)
+      {
+        mismatch(std::string("'") + want.name + "' is " + std::to_string(found->size) + " bytes/align " +
+                 std::to_string(found->align) + ", expected " + std::to_string(want.size) + "/" +
+                 std::to_string(want.align));
+      }
+    }
+    return reason;
+  }
+
+  /// @brief 创建绑定到当前加载代数的符号句柄(开启调用统计时同时关联该符号的计数器)
+  template <typename F>
+  bound_symbol<F> make_bound(symbol_pointer_t<F> fn, const name_ref &symbol_name) const noexcept
+  {
+    bound_symbol<F> bound(fn, state_, state_->generation.load(std::memory_order_relaxed));
+#ifdef DLL_ENABLE_INSTRUMENTATION
+    bound.counters_ = state_->profile.counters(symbol_name.c_str(), symbol_name.size());
+#else
+    (void)symbol_name;
+#endif
+    return bound;
+  }
+
+  /// @brief 按加载选项加载, options.lazy 时只记录路径与选项
+  void open(const std::string &libPath, const load_options &options)
+  {
+    if (!options.lazy)
+    {
+      load_handle(libPath, native_flags(options), libPath, options.cache_path);
+      warm_up(options.warmup);
+      return;
+    }
+    if (!state_) state_ = std::make_shared<detail::library_state>();  // 绑定的句柄与线程缓存在加载前就可能访问
+    lazy_.reset(new detail::lazy_load(libPath, native_flags(options), options.cache_path, options.warmup));
+  }
+
+  /// @brief 加载选项对应的平台原生加载标志
+  static detail::load_flags_t native_flags(const load_options &options) noexcept
+  {
+#if defined(_WIN32) || defined(_WIN64)
+    if (options.restrict_search && (options.flags & detail::search_flags_mask) == 0)
+    {
+      return options.flags | detail::restricted_search_flags;
+    }
+#endif
+    return options.flags;
+  }
+
+  /// @brief 延迟加载: 第一次调用时加载(并发调用只有一个线程加载, 其余等待结果), 返回是否加载成功
+  /// @throw std::system_error call_once 本身失败时抛出异常(加载失败不抛出, 记录在 lazy_->error 中)
+  bool open_lazy() const
+  {
+    detail::lazy_load &lazy = *lazy_;
+    if (!lazy.done.load(std::memory_order_acquire))
+    {
+      std::call_once(lazy.once, [this, &lazy] {
+        try
+        {
+          open_handle(lazy.path, lazy.flags, lazy.path, lazy.cache_path);
+        }
+        catch (...)
+        {
+          lazy.error = std::current_exception();
+        }
+        lazy.done.store(true, std::memory_order_release);  // 先发布加载结果, 预热中的查找不再进入 call_once
+        if (!lazy.error) warm_up(lazy.warmup);
+      });
+    }
+    return !lazy.error;
+  }
+
+  /// @brief 动态库是否可用(延迟加载时触发加载)
+  bool opened() const noexcept
+  {
+    if (!lazy_) return handle_ != nullptr;
+    try
+    {
+      return open_lazy();
+    }
+    catch (const std::system_error &)
+    {
+      return false;  // call_once 失败: 视为未加载, 抛出异常的接口通过 require_lazy() 报告
+    }
+  }
+
+  /// @brief 延迟加载时触发加载, 加载失败则重新抛出加载时的异常(call_once 本身失败时抛出 std::system_error)
+  void require_lazy() const
+  {
+    if (lazy_ && !open_lazy()) std::rethrow_exception(lazy_->error);
+  }
+
   /// @brief 只加载动态库, 加载失败抛出异常`std::runtime_error`
   /// @param libPath 动态库路径
-  void load_handle(const std::string &libPath)
+  /// @param flags 平台原生加载标志
+  void load_handle(const std::string &libPath, detail::load_flags_t flags = detail::default_load_flags)
+  {
+    load_handle(libPath, flags, libPath);
+  }
+
+  /// @brief 只加载动态库, name 为记录到 path()、错误信息和跟踪事件中的名称
+  /// @param cache_path 不含目录的库名优先加载上次解析到的完整路径, 首次加载成功后记录该路径(load_options::cache_path)
+  void load_handle(const std::string &libPath, detail::load_flags_t flags, const std::string &name,
+                   bool cache_path = false)
+  {
+    if (!state_) state_ = std::make_shared<detail::library_state>();
+    open_handle(libPath, flags, name, cache_path);
+  }
+
+  /// @brief 加载动态库并发布新的加载代数(state_ 必须已创建)
+  ///
+  /// 只写入 mutable 成员(handle_/path_/index_), 所以延迟加载可以在 const 的首次使用中调用, 不需要 const_cast
+  void open_handle(const std::string &libPath, detail::load_flags_t flags, const std::string &name,
+                   bool cache_path) const
   {
-    handle_ = detail::load_library(libPath);
+    const detail::trace_sink *sink = detail::current_trace_sink();
+    const std::uint64_t start = sink ? detail::trace_now_ns() : 0;
+    const std::string key = cache_path ? detail::path_cache::key(libPath, flags) : std::string();
+    if (!key.empty())
+    {
+      detail::path_cache &cache = detail::path_cache::instance();
+      const std::string resolved = cache.find(key);
+      handle_ = resolved.empty() ? nullptr : detail::load_library(resolved, flags);
+      if (handle_ == nullptr)
+      {
+        if (!resolved.empty()) cache.erase(key);  // 缓存的路径已失效, 回退为按库名搜索
+        handle_ = detail::load_library(libPath, flags);
+        if (handle_ != nullptr) cache.store(key, detail::module_path(handle_));
+      }
+    }
+    else
+    {
+      handle_ = detail::load_library(libPath, flags);
+    }
     if (handle_ == nullptr)
     {
-      throw std::runtime_error("[dynamic_library] error: Failed to load library: '" + libPath + "' " +
-                               detail::get_last_error());
+      std::string reason = detail::get_last_error();  // 先取错误信息, 回调可能覆盖 dlerror 状态
+      if (sink) detail::emit_trace(sink, trace_event_type::load, name, nullptr, 0, start, false);
+      throw std::runtime_error(detail::format_error("Failed to load library", name.c_str(), name.size(), reason));
     }
+    if (sink) detail::emit_trace(sink, trace_event_type::load, name, nullptr, 0, start, true);
+    path_ = name;
+    if (index_enabled_) index_.build(handle_);
+    state_->cache_generation.store(detail::next_generation(), std::memory_order_release);
+    state_->generation.store(detail::next_generation(), std::memory_order_release);
   }
 
   /// @brief 只是卸载动态库
   void unload_handle() noexcept
   {
+    lazy_.reset();  // 尚未触发的延迟加载也一并取消
     if (handle_ != nullptr)  // 只有在 handle 非 nullptr 时才卸载
     {
+      state_->generation.store(0, std::memory_order_release);  // 先让已绑定的句柄失效
+      index_.clear();                                          // 索引中的名称指向动态库内存
+      const detail::trace_sink *sink = detail::current_trace_sink();
+      const std::uint64_t start = sink ? detail::trace_now_ns() : 0;
       detail::unload_library(handle_);
+      if (sink) detail::emit_trace(sink, trace_event_type::unload, path_, nullptr, 0, start, true);
       handle_ = nullptr;
+      path_.clear();
+      if (!temp_file_.empty())
+      {
+        detail::remove_file(temp_file_);
+        temp_file_.clear();
+      }
+    }
+  }
+
+  /// @brief 解析符号地址(设置了跟踪回调时报告 resolve 事件)
+  void *resolve(const name_ref &name) const noexcept
+  {
+    const detail::trace_sink *sink = detail::current_trace_sink();
+    if (sink == nullptr) return resolve_symbol(name);
+    const std::uint64_t start = detail::trace_now_ns();
+    void *sym = resolve_symbol(name);
+    detail::emit_trace(sink, trace_event_type::resolve, path_, name.c_str(), name.size(), start, sym != nullptr);
+    return sym;
+  }
+
+  /// @brief 解析符号地址: 启用导出表索引时先查索引(未命中直接返回), 否则交给 dlsym/GetProcAddress
+  void *resolve_symbol(const name_ref &name) const noexcept
+  {
+    if (!opened()) return nullptr;
+    if (index_.ready())
+    {
+      void *address = nullptr;
+      switch (index_.find(name.c_str(), name.size(), address))
+      {
+      case detail::export_index::result::found: return address;
+      case detail::export_index::result::missing: return nullptr;
+      case detail::export_index::result::fallback: break;
+      }
+    }
+    return detail::load_symbol<void>(handle_, name.c_str());
+  }
+
+  /// @brief 带缓存的符号查找(缓存命中与否定项都直接返回), 未命中时解析并写入缓存
+  /// @param from_cache 可选, 输出结果是否来自缓存
+  void *lookup(const name_ref &name, bool *from_cache = nullptr) const noexcept
+  {
+    if (!opened()) return nullptr;
+    const detail::trace_sink *sink = detail::current_trace_sink();
+    const std::uint64_t start = sink ? detail::trace_now_ns() : 0;
+    void *sym = nullptr;
+    if (find_cache(name, sym))
+    {
+      if (sink)
+      {
+        detail::emit_trace(sink, trace_event_type::cache_hit, path_, name.c_str(), name.size(), start, sym != nullptr);
+      }
+      if (from_cache) *from_cache = true;
+      return sym;
     }
+    sym = resolve(name);
+    add_cache(name, sym);  // 不存在的符号也缓存(否定缓存)
+    return sym;
+  }
+
+  /// @brief 符号查找失败的原因; cached 表示命中了否定缓存, 此时重新解析一次以取得加载器给出的原因(只在失败路径上)
+  std::string lookup_error(const name_ref &name, bool cached = false) const
+  {
+    if (index_.ready()) return "Symbol is not exported by the library (export index)";
+    if (cached) resolve_symbol(name);
+    return detail::get_last_error();
   }
 
   /// @brief 清除符号表缓存
   void clear_cache() const noexcept
   {
     std::lock_guard<std::mutex> lock(mtx_);
+    // 先更换缓存代数, 让所有线程本地缓存中的旧槽位失效
+    if (state_) state_->cache_generation.store(detail::next_generation(), std::memory_order_release);
     cache_.clear();
   }
 
+  /// @brief 查找符号缓存, 命中返回 true(sym 为 nullptr 表示已知不存在); lock_free/thread_local_tier 模式下不加锁
+  bool find_cache(const name_ref &name, void *&sym) const noexcept
+  {
+    if (mode_ == cache_mode::thread_local_tier) return find_thread_cache(name, sym);
+    if (mode_ == cache_mode::lock_free) return cache_.find(name.c_str(), name.size(), sym);
+    std::lock_guard<std::mutex> lock(mtx_);
+    return cache_.find(name.c_str(), name.size(), sym);
+  }
+
+  /// @brief 先查当前线程的缓存, 未命中再查共享缓存(无锁)并回填线程缓存
+  bool find_thread_cache(const name_ref &name, void *&sym) const noexcept
+  {
+    const std::uint64_t generation = state_->cache_generation.load(std::memory_order_acquire);
+    const std::size_t len = name.size();
+    const std::size_t h = detail::hash_name(name.c_str(), len);
+    detail::thread_symbol_cache::slot &slot = detail::thread_symbol_cache::at(generation, h);
+    if (slot.generation == generation && slot.hash == h && slot.len == len &&
+        std::memcmp(slot.name, name.c_str(), len) == 0)
+    {
+      sym = slot.value;
+      return true;
+    }
+    const char *stored = nullptr;
+    if (!cache_.find(name.c_str(), len, h, sym, stored)) return false;
+    slot = detail::thread_symbol_cache::slot{generation, h, stored, len, sym};
+    return true;
+  }
+
+  /// @brief 添加符号缓存(写操作总是加锁), sym 为 nullptr 时记录为否定项
+  void add_cache(const name_ref &name, void *sym) const noexcept
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    try
+    {
+      cache_.insert(name.c_str(), name.size(), sym);
+    }
+    catch (...)
+    {
+      // 缓存只是优化, 内存不足时放弃缓存, 不影响查找结果
+    }
+  }
+
  private:
-  library_handle handle_{nullptr};                         // 动态库句柄
-  mutable std::unordered_map<std::string, void *> cache_;  // 符号缓存
-  mutable std::mutex mtx_;                                 // 互斥锁, 保护符号缓存线程安全
+  // handle_/path_/index_ 为 mutable: 延迟加载时在 const 的首次使用中写入(由 call_once 串行化)
+  mutable library_handle handle_{nullptr};        // 动态库句柄
+  mutable std::string path_;                      // 动态库路径(加载成功后记录)
+  std::string temp_file_;                         // load_from_memory 写出的临时文件(只有 Windows), 卸载后删除
+  std::unique_ptr<detail::lazy_load> lazy_;       // 延迟加载的参数与状态(只有 load_options::lazy 时创建)
+  cache_mode mode_{cache_mode::locked};           // 符号缓存模式
+  bool index_enabled_{false};                     // 是否在加载时构建导出表索引
+  std::shared_ptr<detail::library_state> state_;  // 加载状态, 与绑定的符号句柄共享
+  mutable detail::symbol_cache cache_;            // 符号缓存(异构查找, 不构造 key)
+  mutable detail::export_index index_;            // 导出表索引(可选)
+  mutable std::mutex mtx_;                        // 互斥锁, 保护符号缓存线程安全(无锁模式下只保护写)
 };
 
 }  // namespace dll
 
+/**
+ * @brief 定义符号表: 用 X-macro 列出一组函数符号, 生成由类型化函数指针组成的结构体
+ *
+ *   #define DYNAMIC_API(X)       \
+ *     X(sayHello, void())        \
+ *     X(intAdd, int(int, int))
+ *   DLL_SYMBOL_TABLE(dynamic_api, DYNAMIC_API)
+ *
+ *   dynamic_api api = lib.load_table<dynamic_api>();  // 一次性加载, 统一报告缺失符号
+ *   api.intAdd(1, 2);                                 // 直接调用结构体成员
+ *
+ * @note 成员名即符号名; 类型中若含有不在括号内的逗号(如模板参数), 请先用 using 定义别名
+ */
+#define DLL_SYMBOL_TABLE(table_name, SYMBOLS)  \
+  struct table_name                            \
+  {                                            \
+    SYMBOLS(DLL_SYMBOL_TABLE_MEMBER_)          \
+    template <typename Visitor>                \
+    void dll_visit_symbols(Visitor &visitor)   \
+    {                                          \
+      SYMBOLS(DLL_SYMBOL_TABLE_VISIT_)         \
+    }                                          \
+  };
+
+#define DLL_SYMBOL_TABLE_MEMBER_(name, type) ::dll::detail::symbol_pointer_t<type> name{nullptr};
+#define DLL_SYMBOL_TABLE_VISIT_(name, type) visitor(#name, this->name);
+
 #endif  // DYNAMIC_LIBRARY_H
\ No newline at end of file
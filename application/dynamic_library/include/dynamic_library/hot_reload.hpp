@@ -0,0 +1,308 @@
+/*********************************************************************************************************
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * @file: hot_reload.hpp
+ * @description: Hot-reload of plugins without stopping callers (epoch-based reclamation)
+ *    - `dll::hot_library<Table>` owns the current plugin version: a dynamic_library plus its resolved
+ *      `DLL_SYMBOL_TABLE` struct. `reload()` loads the new version alongside the old one and switches
+ *      the table with a single atomic pointer exchange.
+ *    - Callers `pin()` the current version; a pinned version (and its handle) stays alive until the
+ *      guard is released. Retired versions are freed once no pinned caller can still observe them.
+ *
+ * Notes:
+ *    - The call path takes no lock: pin() claims a reader slot with one CAS and loads the current pointer.
+ *    - With the same path the system loader returns the already loaded object, so each new plugin build
+ *      must be loaded from its own file (e.g. libstrategy.so.42).
+ *
+ * @license: MIT
+ * @repository: https://github.com/abin-z/DynamicLibLoader
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *********************************************************************************************************/
+
+#pragma once
+#ifndef DYNAMIC_LIBRARY_HOT_RELOAD_H
+#define DYNAMIC_LIBRARY_HOT_RELOAD_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dynamic_library.hpp"
+
+namespace dll
+{
+namespace detail
+{
+/// @brief 纪元回收的读者槽位: 0 表示空闲, 非 0 表示持有者进入时观察到的全局纪元
+struct epoch_slot
+{
+  std::atomic<std::uint64_t> epoch{0};
+  char padding[64 - sizeof(std::atomic<std::uint64_t>)];  // 独占缓存行, 避免读者之间伪共享
+};
+
+/// @brief 读者槽位块, 槽位不够时以无锁链表的方式追加新块
+struct epoch_slot_chunk
+{
+  static constexpr std::size_t size = 64;
+  epoch_slot slots[size];
+  std::atomic<epoch_slot_chunk *> next{nullptr};
+};
+
+/// @brief 当前线程首选的槽位下标, 让不同线程尽量落在不同槽位上
+inline std::size_t epoch_slot_hint() noexcept
+{
+  static std::atomic<std::size_t> counter{0};
+  thread_local std::size_t hint = counter.fetch_add(1, std::memory_order_relaxed);
+  return hint;
+}
+}  // namespace detail
+
+/**
+ * @brief 可热更新的插件: 新版本与旧版本并存加载, 原子切换符号表, 旧版本在所有调用者离开后释放
+ *
+ * @tparam Table 由 DLL_SYMBOL_TABLE 声明的符号表类型
+ *
+ * 使用方式:
+ * @code
+ *   dll::hot_library<strategy_api> strategy("./libstrategy.so.1");
+ *   // 调用线程
+ *   auto pinned = strategy.pin();     // 固定当前版本, 之后的热更新不会影响本次调用
+ *   pinned->on_tick(price);
+ *   // 发布线程
+ *   strategy.reload("./libstrategy.so.2");  // 新版本加载失败时抛出异常, 旧版本继续服务
+ * @endcode
+ */
+template <typename Table>
+class hot_library
+{
+  struct version
+  {
+    dynamic_library library;  // 本版本的动态库句柄
+    Table table;              // 本版本解析好的符号表
+    std::string path;         // 动态库路径
+    std::uint64_t number;     // 版本号, 从 1 开始, 每次 reload 加 1
+
+    version(const std::string &lib_path, const load_options &options) :
+      library(lib_path, options), table(library.template load_table<Table>()), path(lib_path), number(0)
+    {
+    }
+  };
+
+ public:
+  /// @brief 固定某个版本的读者守卫; 存活期间该版本不会被释放. 不可拷贝, 可移动
+  class pinned
+  {
+   public:
+    pinned(pinned &&other) noexcept : slot_(other.slot_), version_(other.version_)
+    {
+      other.slot_ = nullptr;
+      other.version_ = nullptr;
+    }
+    pinned(const pinned &) = delete;
+    pinned &operator=(const pinned &) = delete;
+    pinned &operator=(pinned &&) = delete;
+
+    ~pinned()
+    {
+      if (slot_) slot_->epoch.store(0, std::memory_order_release);
+    }
+
+    /// @brief 访问固定版本的符号表
+    const Table *operator->() const noexcept
+    {
+      return &version_->table;
+    }
+    const Table &operator*() const noexcept
+    {
+      return version_->table;
+    }
+
+    /// @brief 固定版本的动态库, 可用于查找符号表之外的符号
+    const dynamic_library &library() const noexcept
+    {
+      return version_->library;
+    }
+
+    /// @brief 固定版本的版本号
+    std::uint64_t version_number() const noexcept
+    {
+      return version_->number;
+    }
+
+    /// @brief 固定版本的动态库路径
+    const std::string &path() const noexcept
+    {
+      return version_->path;
+    }
+
+   private:
+    friend class hot_library;
+    pinned(detail::epoch_slot *slot, const version *v) noexcept : slot_(slot), version_(v) {}
+
+    detail::epoch_slot *slot_;
+    const version *version_;
+  };
+
+  /**
+   * @brief 加载插件的第一个版本
+   * @param path 动态库路径
+   * @param options 加载选项
+   * @throw std::runtime_error 加载失败或符号表中有符号缺失时抛出异常
+   */
+  explicit hot_library(const std::string &path, const load_options &options = load_options())
+  {
+    std::unique_ptr<version> first(new version(path, options));
+    first->number = 1;
+    current_.store(first.release(), std::memory_order_release);
+  }
+
+  hot_library(const hot_library &) = delete;
+  hot_library &operator=(const hot_library &) = delete;
+
+  /// @brief 析构时释放所有版本, 调用者需保证已没有存活的 pinned 守卫
+  ~hot_library()
+  {
+    delete current_.load(std::memory_order_acquire);
+    for (auto &r : retired_) delete r.first;
+    detail::epoch_slot_chunk *chunk = head_.next.load(std::memory_order_acquire);
+    while (chunk)
+    {
+      detail::epoch_slot_chunk *next = chunk->next.load(std::memory_order_acquire);
+      delete chunk;
+      chunk = next;
+    }
+  }
+
+  /**
+   * @brief 固定当前版本(调用路径, 无锁)
+   * @return 读者守卫, 通过 operator-> 访问符号表
+   */
+  pinned pin() const
+  {
+    detail::epoch_slot *slot = enter();
+    return pinned(slot, current_.load(std::memory_order_seq_cst));
+  }
+
+  /**
+   * @brief 固定当前版本并执行 fn(const Table &)
+   * @return fn 的返回值
+   */
+  template <typename Fn>
+  auto with(Fn &&fn) const -> decltype(std::forward<Fn>(fn)(std::declval<const Table &>()))
+  {
+    pinned p = pin();
+    return std::forward<Fn>(fn)(*p);
+  }
+
+  /**
+   * @brief 热更新: 加载新版本(与旧版本并存)并原子切换, 旧版本待所有调用者离开后释放
+   * @param path 新版本的动态库路径(需与正在使用的文件不同)
+   * @param options 加载选项
+   * @return 新版本的版本号
+   * @throw std::runtime_error 新版本加载失败或符号缺失时抛出异常, 此时旧版本不受影响
+   */
+  std::uint64_t reload(const std::string &path, const load_options &options = load_options())
+  {
+    std::unique_ptr<version> next(new version(path, options));  // 在锁外加载, 不阻塞其他发布者
+    std::lock_guard<std::mutex> lock(mtx_);
+    next->number = current_.load(std::memory_order_relaxed)->number + 1;
+    const std::uint64_t number = next->number;
+    version *old = current_.exchange(next.release(), std::memory_order_seq_cst);
+    // 在切换之后推进纪元: 纪元 < retire_epoch 的读者可能还持有旧版本
+    const std::uint64_t retire_epoch = epoch_.fetch_add(1, std::memory_order_seq_cst) + 1;
+    retired_.emplace_back(old, retire_epoch);
+    reclaim_locked();
+    return number;
+  }
+
+  /**
+   * @brief 释放已没有调用者的旧版本(reload() 会自动调用, 也可以定期手动调用)
+   * @return 仍在等待调用者离开的旧版本数量
+   */
+  std::size_t reclaim()
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return reclaim_locked();
+  }
+
+  /// @brief 当前版本号
+  std::uint64_t version_number() const noexcept
+  {
+    return current_.load(std::memory_order_acquire)->number;
+  }
+
+ private:
+  using retired_version = std::pair<version *, std::uint64_t>;  // 旧版本及其退休纪元
+
+  /// @brief 进入读临界区: 用当前纪元占用一个空闲槽位
+  detail::epoch_slot *enter() const
+  {
+    const std::uint64_t e = epoch_.load(std::memory_order_seq_cst);
+    const std::size_t hint = detail::epoch_slot_hint();
+    detail::epoch_slot_chunk *chunk = &head_;
+    detail::epoch_slot_chunk *last = chunk;
+    for (; chunk; chunk = chunk->next.load(std::memory_order_acquire))
+    {
+      for (std::size_t i = 0; i < detail::epoch_slot_chunk::size; ++i)
+      {
+        detail::epoch_slot &slot = chunk->slots[(hint + i) % detail::epoch_slot_chunk::size];
+        std::uint64_t expected = 0;
+        if (slot.epoch.load(std::memory_order_relaxed) == 0 &&
+            slot.epoch.compare_exchange_strong(expected, e, std::memory_order_seq_cst))
+        {
+          return &slot;
+        }
+      }
+      last = chunk;
+    }
+    // 所有槽位都被占用(并发读者或嵌套 pin 过多), 追加一个新块, 发布前先占好第一个槽位
+    std::unique_ptr<detail::epoch_slot_chunk> fresh(new detail::epoch_slot_chunk());
+    fresh->slots[0].epoch.store(e, std::memory_order_seq_cst);
+    detail::epoch_slot *slot = &fresh->slots[0];
+    detail::epoch_slot_chunk *expected = nullptr;
+    while (!last->next.compare_exchange_weak(expected, fresh.get(), std::memory_order_acq_rel))
+    {
+      last = expected;
+      expected = nullptr;
+    }
+    fresh.release();
+    return slot;
+  }
+
+  /// @brief 释放所有读者都不可能再观察到的旧版本(调用者需持有 mtx_)
+  std::size_t reclaim_locked()
+  {
+    std::uint64_t oldest = std::numeric_limits<std::uint64_t>::max();  // 正在读的读者中最早进入的纪元
+    for (const detail::epoch_slot_chunk *chunk = &head_; chunk; chunk = chunk->next.load(std::memory_order_acquire))
+    {
+      for (const auto &slot : chunk->slots)
+      {
+        std::uint64_t e = slot.epoch.load(std::memory_order_seq_cst);
+        if (e != 0 && e < oldest) oldest = e;
+      }
+    }
+    auto keep = std::remove_if(retired_.begin(), retired_.end(), [oldest](const retired_version &r) {
+      if (r.second > oldest) return false;  // 仍可能被纪元更早的读者持有
+      delete r.first;
+      return true;
+    });
+    retired_.erase(keep, retired_.end());
+    return retired_.size();
+  }
+
+  std::atomic<version *> current_{nullptr};  // 当前版本, 读者通过 pin() 获取
+  std::atomic<std::uint64_t> epoch_{1};      // 全局纪元, 每次切换版本后加 1
+  mutable detail::epoch_slot_chunk head_;    // 第一个读者槽位块
+  std::mutex mtx_;                           // 串行化 reload/reclaim, 不在调用路径上
+  std::vector<retired_version> retired_;     // 等待回收的旧版本
+};
+
+}  // namespace dll
+
+#endif  // DYNAMIC_LIBRARY_HOT_RELOAD_H
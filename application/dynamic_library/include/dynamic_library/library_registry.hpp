@@ -0,0 +1,177 @@
+/*********************************************************************************************************
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * @file: library_registry.hpp
+ * @description: Process-wide registry of shared, reference-counted dll::dynamic_library instances
+ *    - `library_registry::instance().acquire(path)` returns a `std::shared_ptr<const dynamic_library>`.
+ *    - Instances are keyed by canonical path, so every subsystem opening the same plugin shares one handle
+ *      and one symbol cache; the library is unloaded when the last reference goes away.
+ *
+ * @license: MIT
+ * @repository: https://github.com/abin-z/DynamicLibLoader
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *********************************************************************************************************/
+
+#pragma once
+#ifndef DYNAMIC_LIBRARY_REGISTRY_H
+#define DYNAMIC_LIBRARY_REGISTRY_H
+
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "dynamic_library.hpp"
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <climits>
+#endif
+
+namespace dll
+{
+/**
+ * @brief 动态库注册表: 按规范化路径共享引用计数的 dynamic_library 实例
+ *
+ * - 同一路径只加载一次, 所有使用者共享同一个句柄和同一份符号缓存
+ * - 返回 `shared_ptr<const dynamic_library>`, 使用者只能查找/调用符号, 不能 unload() 影响其他使用者
+ * - 最后一个引用释放时动态库自动卸载, 之后再次 acquire() 会重新加载
+ * - 不同路径可以并发加载, 同一路径的并发 acquire() 只会加载一次
+ */
+class library_registry
+{
+ public:
+  using library_ptr = std::shared_ptr<const dynamic_library>;
+
+  library_registry() = default;
+  library_registry(const library_registry &) = delete;
+  library_registry &operator=(const library_registry &) = delete;
+
+  /// @brief 进程级注册表
+  static library_registry &instance()
+  {
+    static library_registry registry;
+    return registry;
+  }
+
+  /**
+   * @brief 获取共享的动态库实例, 尚未加载(或已被全部释放)时按 options 加载
+   * @param path 动态库路径
+   * @param options 加载选项, 只在真正加载时生效; 多个使用者共享时推荐 cache_mode::lock_free
+   * @return 共享的动态库实例
+   * @throw std::runtime_error 加载失败时抛出异常
+   */
+  library_ptr acquire(const std::string &path, const load_options &options = load_options())
+  {
+    std::shared_ptr<entry> e;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      const std::string key = canonical_path(path);
+      auto it = entries_.find(key);
+      if (it == entries_.end())
+      {
+        purge_locked();  // 新增条目时顺便清理已失效的条目
+        it = entries_.emplace(key, std::make_shared<entry>()).first;
+      }
+      e = it->second;
+    }
+    std::lock_guard<std::mutex> lock(e->mtx);  // 同一路径串行加载, 不同路径互不阻塞
+    library_ptr lib = e->library.lock();
+    if (!lib)
+    {
+      lib = std::make_shared<const dynamic_library>(path, options);
+      e->library = lib;
+    }
+    return lib;
+  }
+
+  /// @brief 查找已加载的共享实例, 不会触发加载; 不存在时返回 nullptr
+  library_ptr find(const std::string &path) const
+  {
+    std::shared_ptr<entry> e;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      auto it = entries_.find(canonical_path(path));
+      if (it == entries_.end()) return nullptr;
+      e = it->second;
+    }
+    std::lock_guard<std::mutex> lock(e->mtx);
+    return e->library.lock();
+  }
+
+  /// @brief 当前仍被引用的动态库数量(快照)
+  ///
+  /// 先在 mtx_ 下复制条目列表, 释放后再逐个加锁检查: 正在加载的条目会持有 entry::mtx 直到加载完成,
+  /// 持有 mtx_ 等待它会阻塞所有路径的 acquire()
+  std::size_t size() const
+  {
+    std::vector<std::shared_ptr<entry>> snapshot;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      snapshot.reserve(entries_.size());
+      for (const auto &kv : entries_) snapshot.push_back(kv.second);
+    }
+    std::size_t n = 0;
+    for (const auto &e : snapshot)
+    {
+      std::lock_guard<std::mutex> entry_lock(e->mtx);
+      if (!e->library.expired()) ++n;
+    }
+    return n;
+  }
+
+  /// @brief 规范化动态库路径: 存在的文件解析为绝对路径(POSIX 解析符号链接, Windows 忽略大小写),
+  ///        不存在的路径(如交给系统搜索的库名)保持原样
+  static std::string canonical_path(const std::string &path)
+  {
+#if defined(_WIN32) || defined(_WIN64)
+    std::wstring full = detail::full_path(detail::widen_path(path));  // 按 UTF-8 解释, 支持非 ASCII 路径
+    if (full.empty()) return path;
+    CharLowerBuffW(&full[0], static_cast<DWORD>(full.size()));
+    return detail::narrow_path(full);
+#else
+    char buf[PATH_MAX];
+    return realpath(path.c_str(), buf) != nullptr ? std::string(buf) : path;
+#endif
+  }
+
+ private:
+  struct entry
+  {
+    std::mutex mtx;                               // 保护 library, 串行化同一路径的加载
+    std::weak_ptr<const dynamic_library> library;  // 不持有所有权, 最后一个使用者释放时卸载
+  };
+
+  /// @brief 清理已经没有使用者的条目(调用者需持有 mtx_)
+  ///
+  /// 只清理 entries_ 持有唯一引用的条目: 条目的副本只在持有 mtx_ 时产生, use_count() == 1 说明没有线程
+  /// 已经取得条目但尚未加锁加载(否则它会加载到被删除的条目中, 同一路径被加载两次)
+  void purge_locked()
+  {
+    for (auto it = entries_.begin(); it != entries_.end();)
+    {
+      if (it->second.use_count() != 1)
+      {
+        ++it;
+        continue;
+      }
+      std::unique_lock<std::mutex> entry_lock(it->second->mtx, std::try_to_lock);
+      if (entry_lock.owns_lock() && it->second->library.expired())
+      {
+        entry_lock.unlock();
+        it = entries_.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+  }
+
+  mutable std::mutex mtx_;                                          // 保护 entries_
+  std::unordered_map<std::string, std::shared_ptr<entry>> entries_;  // 规范化路径 -> 条目
+};
+
+}  // namespace dll
+
+#endif  // DYNAMIC_LIBRARY_REGISTRY_H
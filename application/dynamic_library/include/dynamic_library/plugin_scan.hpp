@@ -0,0 +1,274 @@
+/*********************************************************************************************************
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * @file: plugin_scan.hpp
+ * @description: Bulk loading and symbol resolution for plugin directories
+ *    - `dll::list_libraries(dir)` lists the shared libraries in a directory (sorted, not recursive).
+ *    - `dll::resolve_all(paths, symbols)` / `dll::resolve_directory(dir, symbols)` load every library on a
+ *      thread pool, resolve the same entry points in each and return a `dll::symbol_matrix`: a dense
+ *      libraries x symbols table of addresses plus the per-library `load_result` (library or error).
+ *
+ * Notes:
+ *    - Each worker loads one library, then resolves all symbols with one batched warm_up(); rows are
+ *      written by exactly one worker, so filling the table needs no locking.
+ *    - The matrix owns the loaded libraries: addresses stay valid as long as the matrix is alive.
+ *    - The symbol list can come from a `dll::symbol_manifest` (`manifest.symbols()`).
+ *
+ * @license: MIT
+ * @repository: https://github.com/abin-z/DynamicLibLoader
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *********************************************************************************************************/
+
+#pragma once
+#ifndef DYNAMIC_LIBRARY_PLUGIN_SCAN_H
+#define DYNAMIC_LIBRARY_PLUGIN_SCAN_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "async_loader.hpp"
+#include "dynamic_library.hpp"
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+namespace dll
+{
+/**
+ * @brief 多个动态库 x 同一组符号的解析结果, 由 resolve_all() / resolve_directory() 创建
+ *
+ *   dll::symbol_matrix m = dll::resolve_directory("plugins", {"plugin_init", "plugin_run"});
+ *   for (std::size_t i = 0; i < m.rows(); ++i)
+ *   {
+ *     if (!m.library(i).ok()) { log(m.library(i).error); continue; }
+ *     if (auto init = m.get<int()>(i, 0)) init();
+ *   }
+ */
+class symbol_matrix
+{
+ public:
+  static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+  symbol_matrix() = default;
+
+  symbol_matrix(std::vector<std::string> symbols, std::size_t rows) :
+    symbols_(std::move(symbols)), libraries_(rows), table_(rows * symbols_.size(), nullptr)
+  {
+  }
+
+  symbol_matrix(const symbol_matrix &) = delete;
+  symbol_matrix &operator=(const symbol_matrix &) = delete;
+  symbol_matrix(symbol_matrix &&) = default;
+  symbol_matrix &operator=(symbol_matrix &&) = default;
+
+  /// @brief 动态库数量(行数), 与传入的路径顺序一致
+  std::size_t rows() const noexcept
+  {
+    return libraries_.size();
+  }
+
+  /// @brief 符号数量(列数), 与传入的符号顺序一致
+  std::size_t columns() const noexcept
+  {
+    return symbols_.size();
+  }
+
+  /// @brief 第 row 个动态库的加载结果(路径、动态库对象或错误信息)
+  const load_result &library(std::size_t row) const
+  {
+    return libraries_.at(row);
+  }
+
+  const std::vector<load_result> &libraries() const noexcept
+  {
+    return libraries_;
+  }
+
+  const std::vector<std::string> &symbols() const noexcept
+  {
+    return symbols_;
+  }
+
+  /// @brief 符号所在的列, 不存在时返回 npos
+  std::size_t column(const std::string &symbol) const noexcept
+  {
+    auto it = std::find(symbols_.begin(), symbols_.end(), symbol);
+    if (it == symbols_.end()) return npos;
+    return static_cast<std::size_t>(it - symbols_.begin());
+  }
+
+  /// @brief 符号地址, 动态库加载失败或没有导出该符号时为 nullptr
+  void *at(std::size_t row, std::size_t col) const noexcept
+  {
+    return table_[row * symbols_.size() + col];
+  }
+
+  /// @brief 按函数类型(或变量指针类型)取出符号, 不存在时为 nullptr
+  template <typename F>
+  detail::symbol_pointer_t<F> get(std::size_t row, std::size_t col) const noexcept
+  {
+    return reinterpret_cast<detail::symbol_pointer_t<F>>(at(row, col));
+  }
+
+  bool has(std::size_t row, std::size_t col) const noexcept
+  {
+    return at(row, col) != nullptr;
+  }
+
+  /// @brief 第 row 行的 columns() 个地址(连续存放)
+  void *const *row(std::size_t row) const noexcept
+  {
+    return table_.data() + row * symbols_.size();
+  }
+
+  /// @brief 第 row 个动态库解析到的符号数量
+  std::size_t found(std::size_t row) const noexcept
+  {
+    void *const *begin = this->row(row);
+    return symbols_.size() - static_cast<std::size_t>(std::count(begin, begin + symbols_.size(), nullptr));
+  }
+
+  /// @brief 填充第 row 行: 保存加载结果并解析所有符号(由 resolve_all 调用, 每行只由一个线程写入)
+  void fill(std::size_t row, load_result result)
+  {
+    load_result &entry = libraries_[row];
+    entry = std::move(result);
+    if (!entry.ok()) return;
+    entry.library.warm_up(symbols_);  // 一次加锁批量写入符号缓存, 之后的 try_get 只查缓存
+    void **out = table_.data() + row * symbols_.size();
+    for (std::size_t i = 0; i < symbols_.size(); ++i) out[i] = entry.library.try_get<void *>(symbols_[i]);
+  }
+
+ private:
+  std::vector<std::string> symbols_;    // 列: 符号名称
+  std::vector<load_result> libraries_;  // 行: 每个动态库的加载结果, 持有动态库
+  std::vector<void *> table_;           // rows() x columns() 的符号地址, 按行连续存放
+};
+
+/**
+ * @brief 列出目录中的动态库文件(不递归), 按文件名排序
+ *
+ * - Windows: *.dll
+ * - macOS: *.dylib、*.so
+ * - 其他 POSIX: *.so 以及带版本号的 *.so.N
+ *
+ * @param directory 目录路径(Windows 按 UTF-8 解释)
+ * @return 动态库路径(directory + 分隔符 + 文件名)
+ * @throw std::runtime_error 目录无法打开时抛出异常
+ */
+inline std::vector<std::string> list_libraries(const std::string &directory)
+{
+  std::vector<std::string> names;
+  auto ends_with = [](const std::string &name, const char *suffix) {
+    const std::size_t n = std::strlen(suffix);
+    return name.size() > n && name.compare(name.size() - n, n, suffix) == 0;
+  };
+#if defined(_WIN32) || defined(_WIN64)
+  WIN32_FIND_DATAW data;
+  HANDLE find = FindFirstFileW(detail::widen_path(directory + "\\*").c_str(), &data);
+  if (find == INVALID_HANDLE_VALUE)
+  {
+    throw std::runtime_error(detail::format_error("Failed to list plugin directory", directory.c_str(),
+                                                  directory.size(), detail::get_last_error()));
+  }
+  do
+  {
+    if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) continue;
+    std::string name = detail::narrow_path(data.cFileName);
+    std::string lower = name;
+    for (auto &c : lower)
+    {
+      if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+    if (ends_with(lower, ".dll")) names.push_back(std::move(name));
+  } while (FindNextFileW(find, &data));
+  FindClose(find);
+  const char separator = '\\';
+#else
+  DIR *dir = ::opendir(directory.c_str());
+  if (dir == nullptr)
+  {
+    const std::string reason = std::strerror(errno);
+    throw std::runtime_error(
+      detail::format_error("Failed to list plugin directory", directory.c_str(), directory.size(), reason));
+  }
+  while (const dirent *entry = ::readdir(dir))
+  {
+    const std::string name = entry->d_name;
+#if defined(__APPLE__)
+    const bool library = ends_with(name, ".dylib") || ends_with(name, ".so");
+#else
+    const std::size_t so = name.find(".so.");  // 带版本号: libfoo.so.1、libfoo.so.1.2.3
+    const bool library = ends_with(name, ".so") ||
+                         (so != std::string::npos && so > 0 && so + 4 < name.size() &&
+                          name.find_first_not_of("0123456789.", so + 4) == std::string::npos);
+#endif
+    if (!library) continue;
+    struct stat st;
+    if (::stat((directory + "/" + name).c_str(), &st) == 0 && S_ISREG(st.st_mode)) names.push_back(name);
+  }
+  ::closedir(dir);
+  const char separator = '/';
+#endif
+  std::sort(names.begin(), names.end());
+  std::vector<std::string> paths;
+  paths.reserve(names.size());
+  const bool has_separator = !directory.empty() && (directory.back() == '/' || directory.back() == separator);
+  for (const auto &name : names) paths.push_back(has_separator ? directory + name : directory + separator + name);
+  return paths;
+}
+
+/**
+ * @brief 在线程池上并发加载多个动态库并解析同一组符号; 某个库加载失败不影响其他库(错误记录在对应行)
+ *
+ * @param paths 动态库路径列表(行)
+ * @param symbols 符号名称列表(列), 如 symbol_manifest::symbols()
+ * @param options 加载选项(所有库共用, lazy 被忽略: 每个库都在工作线程中立即加载)
+ * @param max_threads 最大并发数, 0 表示 min(库数量, 硬件线程数)
+ * @return 解析结果表, 持有所有加载成功的动态库
+ */
+inline symbol_matrix resolve_all(const std::vector<std::string> &paths, const std::vector<std::string> &symbols,
+                                 const load_options &options = load_options(), std::size_t max_threads = 0)
+{
+  symbol_matrix matrix(symbols, paths.size());
+  if (paths.empty()) return matrix;
+  if (max_threads == 0) max_threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+  const load_options eager = detail::eager_options(options);
+  std::vector<std::future<void>> done;
+  done.reserve(paths.size());
+  {
+    thread_pool pool(std::min(max_threads, paths.size()));
+    for (std::size_t i = 0; i < paths.size(); ++i)
+    {
+      done.push_back(pool.submit([&matrix, &paths, &eager, i] {
+        matrix.fill(i, detail::load_one(paths[i], eager));
+      }));
+    }
+  }  // 析构时等待所有任务执行完毕
+  for (auto &f : done) f.get();  // fill 只在分配内存失败时抛出异常, 在这里传给调用者
+  return matrix;
+}
+
+/**
+ * @brief 加载目录中的所有动态库(list_libraries)并解析同一组符号
+ *
+ * @throw std::runtime_error 目录无法打开时抛出异常; 单个库的加载失败记录在结果中
+ */
+inline symbol_matrix resolve_directory(const std::string &directory, const std::vector<std::string> &symbols,
+                                       const load_options &options = load_options(), std::size_t max_threads = 0)
+{
+  return resolve_all(list_libraries(directory), symbols, options, max_threads);
+}
+
+}  // namespace dll
+
+#endif  // DYNAMIC_LIBRARY_PLUGIN_SCAN_H
@@ -0,0 +1,871 @@
+/*********************************************************************************************************
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * @file: sandbox.hpp
+ * @description: Out-of-process plugin execution over shared memory (POSIX)
+ *    - `dll::sandboxed_library` forks a child process that loads the plugin; a crash (or a hang, with
+ *      `sandbox_options::timeout`) kills the child only and surfaces as std::runtime_error in the host.
+ *    - `invoke<F>(name, args...)` / `get<F>(name)` mirror dynamic_library. Arguments and results are
+ *      trivially copyable values written straight into a shared-memory ring of call slots (no
+ *      serialization); caller buffers are passed as `dll::in_buffer(p, n)` / `dll::out_buffer(p, n)`.
+ *    - `post<F>(&result, name, args...)` queues calls and `flush()` runs the whole batch with a single
+ *      wake-up round trip.
+ *
+ * Notes:
+ *    - The child is a fork of the host without exec: the shared mapping and the call thunks instantiated
+ *      by the host have the same addresses in both processes. Create sandboxes before starting threads
+ *      that may hold locks (malloc, stdio) across the fork, or rely on the libc's fork handlers.
+ *    - Raw pointer parameters and pointer results are rejected at compile time: host pointers are
+ *      meaningless in the child. Out buffers are copied back when the batch completes.
+ *    - Not available on Windows (`DLL_HAS_SANDBOX` is only defined on POSIX).
+ *
+ * @license: MIT
+ * @repository: https://github.com/abin-z/DynamicLibLoader
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *********************************************************************************************************/
+
+#pragma once
+#ifndef DYNAMIC_LIBRARY_SANDBOX_H
+#define DYNAMIC_LIBRARY_SANDBOX_H
+
+#include "dynamic_library.hpp"
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#define DLL_HAS_SANDBOX 1
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/prctl.h>  // PR_SET_PDEATHSIG
+#endif
+
+namespace dll
+{
+/// @brief 传给沙箱调用的输入缓冲区(调用前复制到共享内存), 由 in_buffer() 创建
+template <typename T>
+struct sandbox_in
+{
+  const T *data;     // 调用者的数据
+  std::size_t size;  // 元素个数
+};
+
+/// @brief 沙箱调用写入的输出缓冲区(批次完成后复制回调用者), 由 out_buffer() 创建
+template <typename T>
+struct sandbox_out
+{
+  T *data;           // 调用者的缓冲区, 必须保持有效直到 flush() 返回
+  std::size_t size;  // 元素个数
+};
+
+/// @brief 把 size 个只读元素作为指针参数传给沙箱中的函数, 如 point2Chars(in_buffer(&p, 1), ...)
+template <typename T>
+sandbox_in<T> in_buffer(const T *data, std::size_t size) noexcept
+{
+  return sandbox_in<T>{data, size};
+}
+
+/// @brief 把调用者的 size 个元素的缓冲区作为输出指针参数传给沙箱中的函数, 如 box2String(b, out_buffer(buf, n), n)
+template <typename T>
+sandbox_out<T> out_buffer(T *data, std::size_t size) noexcept
+{
+  return sandbox_out<T>{data, size};
+}
+
+/// @brief 沙箱选项
+struct sandbox_options
+{
+  load_options library;                  // 子进程加载动态库的选项(lazy 被忽略)
+  std::size_t slots = 64;                // 共享内存中的调用槽位数, 即一个批次最多的调用数
+  std::size_t slot_size = 4096;          // 每个槽位的负载大小: 符号名 + 参数 + 缓冲区 + 返回值
+  std::chrono::milliseconds timeout{0};  // 一个批次的超时时间, 0 表示不限; 超时后终止子进程
+};
+
+namespace detail
+{
+template <std::size_t... I>
+struct index_seq
+{
+};
+
+template <std::size_t N, std::size_t... I>
+struct make_index_seq : make_index_seq<N - 1, N - 1, I...>
+{
+};
+
+template <std::size_t... I>
+struct make_index_seq<0, I...>
+{
+  using type = index_seq<I...>;
+};
+
+/// @brief 子进程中执行一个调用: 按 F 的签名从参数区取出参数, 返回值写入结果区
+using sandbox_thunk = void (*)(void (*fn)(), void *args, void *result);
+
+/// @brief 共享内存头部(位于映射起始处)
+struct sandbox_header
+{
+  std::uint32_t count;       // 本批次的调用数, sandbox_exit 表示子进程退出
+  std::int32_t load_status;  // 子进程加载动态库的结果: 0 成功, -1 失败
+  char error[512];           // 加载失败的原因
+};
+
+/// @brief 一个调用槽位的头部, 其后是负载区(符号名、参数、缓冲区与返回值的偏移都相对负载区)
+struct sandbox_slot
+{
+  sandbox_thunk thunk;          // 调用桩, nullptr 表示只查询符号是否存在
+  std::uint32_t name_offset;    // 符号名(以 '\0' 结尾)
+  std::uint32_t args_offset;    // 参数 tuple
+  std::uint32_t result_offset;  // 返回值
+  std::int32_t status;          // 执行结果: 0 成功, 1 符号不存在
+};
+
+static const std::uint32_t sandbox_exit = 0xFFFFFFFFu;
+static const std::size_t sandbox_slot_header = 64;  // 槽位头部占用的字节数(负载区按缓存行对齐)
+static const std::size_t sandbox_header_size = (sizeof(sandbox_header) + 63) / 64 * 64;
+static_assert(sizeof(sandbox_slot) <= sandbox_slot_header, "sandbox_slot must fit in the slot header");
+
+/// @brief 在槽位负载区中顺序分配一个调用所需的空间, 并记录批次完成后需要复制回调用者的区域
+class sandbox_packer
+{
+ public:
+  struct copy_back
+  {
+    void *dst;          // 调用者的缓冲区
+    const void *src;    // 共享内存中的数据
+    std::size_t bytes;  // 字节数
+  };
+
+  sandbox_packer(unsigned char *base, std::size_t size, const name_ref &name, std::vector<copy_back> &copies) :
+    base_(base), size_(size), used_(0), name_(name), copies_(copies)
+  {
+  }
+
+  /// @throw std::runtime_error 负载区空间不足时抛出异常
+  void *allocate(std::size_t bytes, std::size_t align)
+  {
+    const std::size_t pos = (used_ + align - 1) / align * align;
+    if (pos > size_ || bytes > size_ - pos)
+    {
+      throw std::runtime_error(format_error("Sandbox call does not fit in a slot", name_.c_str(), name_.size(),
+                                            "(increase sandbox_options::slot_size)"));
+    }
+    used_ = pos + bytes;
+    return base_ + pos;
+  }
+
+  std::uint32_t offset_of(const void *p) const noexcept
+  {
+    return static_cast<std::uint32_t>(static_cast<const unsigned char *>(p) - base_);
+  }
+
+  void add_copy_back(void *dst, const void *src, std::size_t bytes)
+  {
+    copies_.push_back(copy_back{dst, src, bytes});
+  }
+
+ private:
+  unsigned char *base_;
+  std::size_t size_;
+  std::size_t used_;
+  const name_ref &name_;
+  std::vector<copy_back> &copies_;
+};
+
+/// @brief 把一个实参转换为形参 P 的值写入参数区: 普通参数按值复制
+template <typename P, typename A>
+struct sandbox_marshal
+{
+  static_assert(!std::is_pointer<P>::value,
+                "sandbox: pointer parameters must be passed as dll::in_buffer() or dll::out_buffer()");
+  static_assert(std::is_trivially_copyable<P>::value, "sandbox: parameters must be trivially copyable");
+
+  template <typename Arg>
+  static P apply(Arg &&arg, sandbox_packer &)
+  {
+    return static_cast<P>(std::forward<Arg>(arg));
+  }
+};
+
+/// @brief 输入缓冲区: 复制到负载区, 形参指向共享内存中的副本
+template <typename P, typename T>
+struct sandbox_marshal<P, sandbox_in<T>>
+{
+  static_assert(std::is_convertible<T *, P>::value, "sandbox: in_buffer element type does not match the parameter");
+
+  static P apply(const sandbox_in<T> &in, sandbox_packer &packer)
+  {
+    T *dst = static_cast<T *>(packer.allocate(in.size * sizeof(T), alignof(T)));
+    if (in.size > 0) std::memcpy(dst, in.data, in.size * sizeof(T));
+    return dst;
+  }
+};
+
+/// @brief 输出缓冲区: 在负载区预留空间, 批次完成后复制回调用者
+template <typename P, typename T>
+struct sandbox_marshal<P, sandbox_out<T>>
+{
+  static_assert(std::is_convertible<T *, P>::value, "sandbox: out_buffer element type does not match the parameter");
+
+  static P apply(const sandbox_out<T> &out, sandbox_packer &packer)
+  {
+    T *dst = static_cast<T *>(packer.allocate(out.size * sizeof(T), alignof(T)));
+    packer.add_copy_back(out.data, dst, out.size * sizeof(T));
+    return dst;
+  }
+};
+
+/// @brief 函数签名 R(P...) 的调用桩, 在宿主中实例化、在子进程中执行(fork 后地址相同)
+template <typename F>
+struct sandbox_caller;
+
+template <typename R, typename... P>
+struct sandbox_caller<R(P...)>
+{
+  static_assert(!std::is_pointer<R>::value, "sandbox: pointer results point into the sandbox process");
+  static_assert(std::is_void<R>::value || std::is_trivially_copyable<R>::value,
+                "sandbox: results must be trivially copyable");
+
+  using result_type = R;
+  using args_type = std::tuple<typename std::decay<P>::type...>;
+
+  static void thunk(void (*fn)(), void *args, void *result)
+  {
+    call(reinterpret_cast<R (*)(P...)>(fn), *static_cast<args_type *>(args), result,
+         typename make_index_seq<sizeof...(P)>::type(), std::is_void<R>());
+  }
+
+  /// @brief 把实参写入 args 指向的参数区
+  template <typename... Args>
+  static void pack(void *args, sandbox_packer &packer, Args &&...a)
+  {
+    static_assert(sizeof...(Args) == sizeof...(P), "sandbox: wrong number of arguments");
+    new (args) args_type(
+      sandbox_marshal<typename std::decay<P>::type, typename std::decay<Args>::type>::apply(std::forward<Args>(a),
+                                                                                           packer)...);
+  }
+
+ private:
+  template <std::size_t... I>
+  static void call(R (*f)(P...), args_type &args, void *result, index_seq<I...>, std::false_type)
+  {
+    new (result) R(f(std::get<I>(args)...));
+  }
+
+  template <std::size_t... I>
+  static void call(R (*f)(P...), args_type &args, void *, index_seq<I...>, std::true_type)
+  {
+    f(std::get<I>(args)...);
+  }
+};
+
+template <typename F>
+using sandbox_caller_t = sandbox_caller<remove_ptr_ref_t<F>>;
+
+/// @brief fork 与关闭子进程端 socket 之间不能有其他沙箱 fork, 否则其子进程会继承该 socket, 崩溃检测失效
+inline std::mutex &sandbox_fork_mutex()
+{
+  static std::mutex m;
+  return m;
+}
+
+inline int sandbox_send_flags() noexcept
+{
+#ifdef MSG_NOSIGNAL
+  return MSG_NOSIGNAL;  // 对端已退出时返回 EPIPE 而不是产生 SIGPIPE
+#else
+  return 0;
+#endif
+}
+}  // namespace detail
+
+template <typename F>
+class sandboxed_function;
+
+/**
+ * @brief 在子进程中加载并调用动态库, 插件崩溃不会影响宿主进程
+ *
+ *   dll::sandboxed_library sb("libdynamic.so");
+ *   int sum = sb.invoke<int(int, int)>("intAdd", 1, 2);
+ *   char buf[128];
+ *   sb.invoke<void(box_t, char *, unsigned)>("box2String", box, dll::out_buffer(buf, sizeof(buf)), sizeof(buf));
+ *
+ *   int results[32];
+ *   for (int i = 0; i < 32; ++i) sb.post<int(int, int)>(&results[i], "intAdd", i, i);
+ *   sb.flush();  // 32 个调用只需一次跨进程往返
+ *
+ * @note 所有成员函数都是线程安全的(调用按批次串行执行)
+ */
+class sandboxed_library
+{
+ public:
+  using name_ref = detail::name_ref;  // 符号名称参数, 接收 const char*、std::string、std::string_view
+
+  /**
+   * @brief 创建子进程并加载动态库
+   *
+   * @param path 动态库路径
+   * @param options 沙箱选项
+   * @throw std::runtime_error 创建共享内存或子进程失败, 或者子进程加载动态库失败时抛出异常
+   */
+  explicit sandboxed_library(const std::string &path, const sandbox_options &options = sandbox_options()) :
+    path_(path), options_(options)
+  {
+    options_.library.lazy = false;
+    if (options_.slots == 0) options_.slots = 1;
+    stride_ = (detail::sandbox_slot_header + options_.slot_size + 63) / 64 * 64;
+    region_size_ = detail::sandbox_header_size + options_.slots * stride_;
+    void *p = ::mmap(nullptr, region_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) fail("Failed to map sandbox memory", std::strerror(errno));
+    region_ = static_cast<unsigned char *>(p);
+    results_.reserve(options_.slots);
+    try
+    {
+      spawn();
+    }
+    catch (...)
+    {
+      ::munmap(region_, region_size_);
+      throw;
+    }
+  }
+
+  ~sandboxed_library()
+  {
+    stop();
+    ::munmap(region_, region_size_);
+  }
+
+  sandboxed_library(const sandboxed_library &) = delete;
+  sandboxed_library &operator=(const sandboxed_library &) = delete;
+
+  /**
+   * @brief 在子进程中调用函数并等待结果(同时执行之前 post() 的调用)
+   *
+   * @tparam F 函数类型, 参数与返回值必须是可平凡复制的类型, 指针参数以 in_buffer()/out_buffer() 传入
+   * @param symbol_name 函数名称
+   * @param args 调用参数
+   * @return 函数返回值
+   * @throw std::runtime_error 符号不存在、子进程崩溃或超时时抛出异常
+   */
+  template <typename F, typename... Args>
+  typename detail::sandbox_caller_t<F>::result_type invoke(const name_ref &symbol_name, Args &&...args)
+  {
+    using R = typename detail::sandbox_caller_t<F>::result_type;
+    typename std::conditional<std::is_void<R>::value, char, R>::type result;
+    std::lock_guard<std::mutex> lock(mutex_);
+    enqueue<F>(&result, symbol_name, std::forward<Args>(args)...);
+    flush_locked();
+    return static_cast<R>(result);
+  }
+
+  /**
+   * @brief 把调用加入当前批次, 由 flush() 或下一次 invoke() 一起执行; 槽位用完时自动执行当前批次
+   *
+   * @param result 返回值的存放位置(批次完成后写入), 可以为 nullptr; 必须保持有效直到批次完成
+   * @param symbol_name 函数名称
+   * @param args 调用参数, out_buffer() 的缓冲区同样需要保持有效直到批次完成
+   */
+  template <typename F, typename... Args>
+  void post(typename detail::sandbox_caller_t<F>::result_type *result, const name_ref &symbol_name, Args &&...args)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    enqueue<F>(result, symbol_name, std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief 执行当前批次中的所有调用并写回返回值与输出缓冲区
+   *
+   * @throw std::runtime_error 有调用的符号不存在(其余调用仍会执行), 或者子进程崩溃、超时时抛出异常
+   */
+  void flush()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    flush_locked();
+  }
+
+  /// @brief 子进程中的动态库是否导出了该符号(会先执行当前批次)
+  bool has_symbol(const name_ref &symbol_name)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool found = false;
+    enqueue_lookup(symbol_name, &found);
+    flush_locked();
+    return found;
+  }
+
+  /**
+   * @brief 获取沙箱中的函数, 返回的对象以 dynamic_library::get 相同的方式调用
+   *
+   * @throw std::runtime_error 符号不存在时抛出异常
+   */
+  template <typename F>
+  sandboxed_function<F> get(const name_ref &symbol_name)
+  {
+    if (!has_symbol(symbol_name))
+    {
+      fail("Failed to load symbol", symbol_name.c_str(), symbol_name.size(), "(not found in sandbox process)");
+    }
+    return sandboxed_function<F>(*this, std::string(symbol_name.c_str(), symbol_name.size()));
+  }
+
+  /// @brief 子进程是否仍在运行(崩溃或超时后为 false, 之后的调用抛出异常直到 restart())
+  bool alive()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return alive_locked();
+  }
+
+  /// @brief 结束当前子进程(如果还在运行)并重新创建, 未执行的调用被丢弃
+  void restart()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop();
+    spawn();
+  }
+
+  /// @brief 子进程 pid, 子进程已退出时为 -1
+  pid_t pid() const noexcept
+  {
+    return pid_;
+  }
+
+  const std::string &path() const noexcept
+  {
+    return path_;
+  }
+
+ private:
+  [[noreturn]] static void fail(const char *what, const char *reason)
+  {
+    throw std::runtime_error(std::string("[dynamic_library] error: ") + what + ": " + reason);
+  }
+
+  [[noreturn]] static void fail(const char *what, const char *name, std::size_t len, const std::string &reason)
+  {
+    throw std::runtime_error(detail::format_error(what, name, len, reason));
+  }
+
+  detail::sandbox_header *header() const noexcept
+  {
+    return reinterpret_cast<detail::sandbox_header *>(region_);
+  }
+
+  detail::sandbox_slot *slot_at(std::size_t i) const noexcept
+  {
+    return reinterpret_cast<detail::sandbox_slot *>(region_ + detail::sandbox_header_size + i * stride_);
+  }
+
+  static unsigned char *payload(detail::sandbox_slot *slot) noexcept
+  {
+    return reinterpret_cast<unsigned char *>(slot) + detail::sandbox_slot_header;
+  }
+
+  template <typename F>
+  using caller = detail::sandbox_caller_t<F>;
+
+  /// @brief 在下一个空闲槽位中写入符号名与参数(调用者持有 mutex_)
+  template <typename F, typename... Args>
+  void enqueue(typename caller<F>::result_type *result, const name_ref &symbol_name, Args &&...args)
+  {
+    using R = typename caller<F>::result_type;
+    using args_type = typename caller<F>::args_type;
+    detail::sandbox_slot *slot = begin_slot();
+    const std::size_t copies = copies_.size();
+    try
+    {
+      detail::sandbox_packer packer(payload(slot), options_.slot_size, symbol_name, copies_);
+      write_name(slot, packer, symbol_name);
+      void *args_area = packer.allocate(sizeof(args_type), alignof(args_type));
+      caller<F>::pack(args_area, packer, std::forward<Args>(args)...);
+      void *result_area = packer.allocate(result_size<R>(), result_align<R>());
+      slot->thunk = &caller<F>::thunk;
+      slot->args_offset = packer.offset_of(args_area);
+      slot->result_offset = packer.offset_of(result_area);
+      results_.push_back(pending_result{std::string(symbol_name.c_str(), symbol_name.size()), result, result_area,
+                                        result ? result_size<R>() : 0, nullptr});
+    }
+    catch (...)
+    {
+      copies_.resize(copies);
+      throw;
+    }
+    ++count_;
+  }
+
+  /// @brief 加入只查询符号是否存在的槽位, 批次完成后结果写入 *found
+  void enqueue_lookup(const name_ref &symbol_name, bool *found)
+  {
+    detail::sandbox_slot *slot = begin_slot();
+    detail::sandbox_packer packer(payload(slot), options_.slot_size, symbol_name, copies_);
+    write_name(slot, packer, symbol_name);
+    slot->thunk = nullptr;
+    results_.push_back(pending_result{std::string(), nullptr, nullptr, 0, found});
+    ++count_;
+  }
+
+  detail::sandbox_slot *begin_slot()
+  {
+    if (!alive_locked()) fail("Sandbox process is not running", path_.c_str(), path_.size(), "(call restart())");
+    if (count_ == options_.slots) flush_locked();
+    detail::sandbox_slot *slot = slot_at(count_);
+    slot->status = 0;
+    return slot;
+  }
+
+  static void write_name(detail::sandbox_slot *slot, detail::sandbox_packer &packer, const name_ref &symbol_name)
+  {
+    char *name = static_cast<char *>(packer.allocate(symbol_name.size() + 1, 1));
+    std::memcpy(name, symbol_name.c_str(), symbol_name.size());
+    name[symbol_name.size()] = '\0';
+    slot->name_offset = packer.offset_of(name);
+  }
+
+  template <typename R>
+  static constexpr std::size_t result_size() noexcept
+  {
+    return std::is_void<R>::value ? 0 : sizeof(typename std::conditional<std::is_void<R>::value, char, R>::type);
+  }
+
+  template <typename R>
+  static constexpr std::size_t result_align() noexcept
+  {
+    return alignof(typename std::conditional<std::is_void<R>::value, char, R>::type);
+  }
+
+  /// @brief 唤醒子进程执行当前批次并等待完成, 然后写回结果(调用者持有 mutex_)
+  ///
+  /// 共享内存可以被子进程(插件)任意改写: 这里只读取每个槽位的 status, 并且只接受 0/1; 符号名、值的
+  /// 大小与写回位置都使用宿主端 results_ / copies_ 中的记录
+  void flush_locked()
+  {
+    if (count_ == 0) return;
+    const std::size_t count = count_;
+    count_ = 0;
+    header()->count = static_cast<std::uint32_t>(count);
+    round_trip();
+
+    std::string errors;
+    bool protocol_error = false;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      const pending_result &r = results_[i];
+      const std::int32_t status = slot_at(i)->status;
+      if (status != 0 && status != 1)
+      {
+        protocol_error = true;
+        break;
+      }
+      if (r.found)  // has_symbol() 的查询
+      {
+        *r.found = status == 0;
+      }
+      else if (status != 0)
+      {
+        if (!errors.empty()) errors += '\n';
+        errors += detail::format_error("Failed to load symbol", r.name.c_str(), r.name.size(),
+                                       "(not found in sandbox process)");
+      }
+      else if (r.bytes > 0)
+      {
+        std::memcpy(r.dst, r.src, r.bytes);
+      }
+    }
+    if (protocol_error)
+    {
+      ::kill(pid_, SIGKILL);
+      reap(nullptr);
+      results_.clear();
+      copies_.clear();
+      fail("Sandbox protocol error", path_.c_str(), path_.size(), "(invalid call status, process killed)");
+    }
+    for (const detail::sandbox_packer::copy_back &c : copies_)
+    {
+      if (c.bytes > 0) std::memcpy(c.dst, c.src, c.bytes);
+    }
+    results_.clear();
+    copies_.clear();
+    if (!errors.empty()) throw std::runtime_error(errors);
+  }
+
+  /// @brief 通知子进程共享内存中有新的批次, 等待它执行完毕
+  void round_trip()
+  {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const char wake = 1;
+    ssize_t n;
+    do
+    {
+      n = ::send(fd_, &wake, 1, detail::sandbox_send_flags());
+    } while (n < 0 && errno == EINTR);
+    if (n == 1) wait_reply();
+    if (n != 1) lost_child();
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+
+  void wait_reply()
+  {
+    if (options_.timeout.count() > 0)
+    {
+      pollfd pfd{fd_, POLLIN, 0};
+      int ready;
+      do
+      {
+        ready = ::poll(&pfd, 1, static_cast<int>(options_.timeout.count()));
+      } while (ready < 0 && errno == EINTR);
+      if (ready == 0)
+      {
+        ::kill(pid_, SIGKILL);
+        reap(0);
+        results_.clear();
+        copies_.clear();
+        fail("Sandbox call timed out", path_.c_str(), path_.size(),
+             "(process killed after " + std::to_string(options_.timeout.count()) + " ms)");
+      }
+    }
+    char reply;
+    ssize_t n;
+    do
+    {
+      n = ::recv(fd_, &reply, 1, 0);
+    } while (n < 0 && errno == EINTR);
+    if (n != 1) lost_child();
+  }
+
+  /// @brief 子进程退出(连接断开): 回收并报告退出原因
+  [[noreturn]] void lost_child()
+  {
+    int status = 0;
+    reap(&status);
+    results_.clear();
+    copies_.clear();
+    std::string reason;
+    if (WIFSIGNALED(status))
+    {
+      reason = "(killed by signal " + std::to_string(WTERMSIG(status)) + ": " + ::strsignal(WTERMSIG(status)) + ")";
+    }
+    else
+    {
+      reason = "(exited with status " + std::to_string(WEXITSTATUS(status)) + ")";
+    }
+    fail("Sandbox process terminated", path_.c_str(), path_.size(), reason);
+  }
+
+  /// @brief 关闭连接并等待子进程退出
+  void reap(int *status)
+  {
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+    if (pid_ > 0)
+    {
+      int s = 0;
+      while (::waitpid(pid_, &s, 0) < 0 && errno == EINTR)
+      {
+      }
+      if (status) *status = s;
+    }
+    pid_ = -1;
+  }
+
+  bool alive_locked()
+  {
+    if (pid_ <= 0) return false;
+    int status = 0;
+    if (::waitpid(pid_, &status, WNOHANG) == 0) return true;
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+    pid_ = -1;
+    return false;
+  }
+
+  /// @brief 让子进程正常退出(卸载动态库)并回收
+  void stop()
+  {
+    if (pid_ > 0 && fd_ >= 0)
+    {
+      header()->count = detail::sandbox_exit;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      const char wake = 1;
+      if (::send(fd_, &wake, 1, detail::sandbox_send_flags()) != 1) ::kill(pid_, SIGKILL);
+    }
+    reap(nullptr);
+    count_ = 0;
+    results_.clear();
+    copies_.clear();
+  }
+
+  /// @brief 创建子进程并等待它加载动态库
+  void spawn()
+  {
+    header()->load_status = -1;
+    header()->error[0] = '\0';
+    {
+      std::lock_guard<std::mutex> lock(detail::sandbox_fork_mutex());
+      int fds[2];
+      if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+      {
+        fail("Failed to create sandbox socket", std::strerror(errno));
+      }
+      for (int fd : fds) ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+#ifdef SO_NOSIGPIPE
+      const int on = 1;
+      ::setsockopt(fds[0], SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+      ::setsockopt(fds[1], SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+      std::fflush(nullptr);  // 避免子进程输出时重复写出宿主缓冲中的内容
+      const pid_t pid = ::fork();
+      if (pid < 0)
+      {
+        const int err = errno;
+        ::close(fds[0]);
+        ::close(fds[1]);
+        fail("Failed to fork sandbox process", std::strerror(err));
+      }
+      if (pid == 0)
+      {
+        ::close(fds[0]);
+        serve(fds[1]);
+      }
+      ::close(fds[1]);
+      fd_ = fds[0];
+      pid_ = pid;
+    }
+    wait_reply();
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (header()->load_status != 0)
+    {
+      const char *error = header()->error;  // 子进程中 dynamic_library 抛出的异常信息(可能被插件改写, 限定长度)
+      const std::string message(error, ::strnlen(error, sizeof(header()->error)));
+      reap(nullptr);
+      throw std::runtime_error(message);
+    }
+  }
+
+  /// @brief 子进程主循环: 加载动态库, 然后逐批执行共享内存中的调用, 不返回
+  [[noreturn]] void serve(int fd) noexcept
+  {
+#if defined(__linux__)
+    ::prctl(PR_SET_PDEATHSIG, SIGKILL);  // 宿主进程退出时子进程随之结束
+#endif
+    detail::sandbox_header *h = header();
+    dynamic_library lib;
+    try
+    {
+      lib.load(path_, options_.library);
+      h->load_status = 0;
+    }
+    catch (const std::exception &e)
+    {
+      std::strncpy(h->error, e.what(), sizeof(h->error) - 1);
+      h->error[sizeof(h->error) - 1] = '\0';
+    }
+    for (;;)
+    {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      const char done = 1;
+      if (::send(fd, &done, 1, detail::sandbox_send_flags()) != 1 || h->load_status != 0) ::_exit(1);
+      char wake;
+      ssize_t n;
+      do
+      {
+        n = ::recv(fd, &wake, 1, 0);
+      } while (n < 0 && errno == EINTR);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (n != 1 || h->count == detail::sandbox_exit) break;
+      for (std::uint32_t i = 0; i < h->count; ++i)
+      {
+        detail::sandbox_slot *slot = slot_at(i);
+        unsigned char *base = payload(slot);
+        void (*fn)() = lib.try_get<void()>(reinterpret_cast<const char *>(base + slot->name_offset));
+        if (fn == nullptr)
+        {
+          slot->status = 1;
+          continue;
+        }
+        if (slot->thunk) slot->thunk(fn, base + slot->args_offset, base + slot->result_offset);
+        slot->status = 0;
+      }
+    }
+    lib.unload();
+    ::_exit(0);
+  }
+
+  struct pending_result
+  {
+    std::string name;   // 符号名(宿主端副本, 用于错误信息)
+    void *dst;          // 调用者的返回值存放位置
+    const void *src;    // 共享内存中的返回值
+    std::size_t bytes;  // 0 表示不需要写回
+    bool *found;        // has_symbol() 的查询结果, 普通调用为 nullptr
+  };
+
+  std::string path_;                                       // 动态库路径
+  sandbox_options options_;                                // 沙箱选项
+  unsigned char *region_ = nullptr;                        // 共享内存(头部 + 槽位), fork 前映射, 两个进程地址相同
+  std::size_t region_size_ = 0;                            // 共享内存大小
+  std::size_t stride_ = 0;                                 // 槽位间距(头部 + 负载, 按缓存行对齐)
+  std::size_t count_ = 0;                                  // 当前批次已写入的槽位数
+  std::vector<pending_result> results_;                    // 当前批次每个槽位的返回值写回位置
+  std::vector<detail::sandbox_packer::copy_back> copies_;  // 当前批次需要写回的输出缓冲区
+  pid_t pid_ = -1;                                         // 子进程 pid
+  int fd_ = -1;                                            // 与子进程通信的 socket(只传递唤醒字节)
+  std::mutex mutex_;                                       // 串行化批次
+};
+
+/// @brief 沙箱中的函数, 由 sandboxed_library::get<F>() 返回, 必须在 sandboxed_library 之前销毁
+template <typename F>
+class sandboxed_function
+{
+ public:
+  using result_type = typename detail::sandbox_caller_t<F>::result_type;
+
+  sandboxed_function(sandboxed_library &sandbox, std::string name) : sandbox_(&sandbox), name_(std::move(name)) {}
+
+  /// @brief 同步调用, 等同于 sandboxed_library::invoke<F>()
+  template <typename... Args>
+  result_type operator()(Args &&...args) const
+  {
+    return sandbox_->invoke<F>(name_, std::forward<Args>(args)...);
+  }
+
+  /// @brief 加入当前批次, 等同于 sandboxed_library::post<F>()
+  template <typename... Args>
+  void post(result_type *result, Args &&...args) const
+  {
+    sandbox_->post<F>(result, name_, std::forward<Args>(args)...);
+  }
+
+  const std::string &name() const noexcept
+  {
+    return name_;
+  }
+
+ private:
+  sandboxed_library *sandbox_;  // 所属沙箱
+  std::string name_;            // 函数名称
+};
+
+}  // namespace dll
+
+#endif  // !_WIN32
+
+#endif  // DYNAMIC_LIBRARY_SANDBOX_H
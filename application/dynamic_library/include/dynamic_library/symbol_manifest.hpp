@@ -0,0 +1,346 @@
+/*********************************************************************************************************
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * @file: symbol_manifest.hpp
+ * @description: Symbol manifests for warm starts of dll::dynamic_library
+ *    - `dll::symbol_manifest::record()` captures the symbols a process actually resolved (the positive
+ *      entries of the symbol cache), keyed by the library's fingerprint.
+ *    - `write()`/`read()` persist the manifest as a small binary file; `prefetch()` resolves the whole set
+ *      in one batch on the next start, `dll::prefetch_async()` does the same on a background thread.
+ *    - `dll::library_fingerprint()` identifies a build: the ELF GNU build-id on Linux, the PE timestamp and
+ *      image size on Windows, otherwise the file size and modification time.
+ *
+ * Notes:
+ *    - A manifest whose fingerprint does not match the loaded library is ignored, so a rebuilt plugin
+ *      starts from an empty set instead of prefetching symbols that may no longer exist.
+ *    - Prefetched symbols are cached and therefore recorded again; the set only grows until the build changes.
+ *    - The file is a machine-local cache (native byte order); corrupt or truncated files read as empty.
+ *
+ * @license: MIT
+ * @repository: https://github.com/abin-z/DynamicLibLoader
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *********************************************************************************************************/
+
+#pragma once
+#ifndef DYNAMIC_LIBRARY_SYMBOL_MANIFEST_H
+#define DYNAMIC_LIBRARY_SYMBOL_MANIFEST_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dynamic_library.hpp"
+
+#if !defined(_WIN32)
+#include <sys/stat.h>
+#endif
+
+namespace dll
+{
+namespace detail
+{
+/// @brief 把字节序列转换为小写十六进制字符串
+inline std::string to_hex(const unsigned char *data, std::size_t size)
+{
+  static const char digits[] = "0123456789abcdef";
+  std::string hex;
+  hex.reserve(size * 2);
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    hex.push_back(digits[data[i] >> 4]);
+    hex.push_back(digits[data[i] & 0x0F]);
+  }
+  return hex;
+}
+
+#if defined(_WIN32)
+/// @brief PE 映像标识: 链接时间戳 + 映像大小(与符号服务器定位 PE 文件使用的键相同)
+inline std::string image_fingerprint(library_handle handle)
+{
+  const unsigned char *base = reinterpret_cast<const unsigned char *>(handle);
+  const IMAGE_DOS_HEADER *dos = reinterpret_cast<const IMAGE_DOS_HEADER *>(base);
+  if (dos->e_magic != IMAGE_DOS_SIGNATURE) return std::string();
+  const IMAGE_NT_HEADERS *nt = reinterpret_cast<const IMAGE_NT_HEADERS *>(base + dos->e_lfanew);
+  if (nt->Signature != IMAGE_NT_SIGNATURE) return std::string();
+  char key[48];
+  std::snprintf(key, sizeof(key), "pe:%08lX%lx", static_cast<unsigned long>(nt->FileHeader.TimeDateStamp),
+                static_cast<unsigned long>(nt->OptionalHeader.SizeOfImage));
+  return key;
+}
+#elif defined(__linux__)
+/// @brief 在已加载的 ELF 映像中查找 NT_GNU_BUILD_ID 注释(按加载基址匹配 dl_iterate_phdr 的模块)
+struct build_id_query
+{
+  ElfW(Addr) base;
+  std::string id;
+};
+
+inline int find_build_id(struct dl_phdr_info *info, std::size_t, void *data)
+{
+  build_id_query *query = static_cast<build_id_query *>(data);
+  if (info->dlpi_addr != query->base) return 0;
+  auto align4 = [](std::size_t n) { return (n + 3) & ~static_cast<std::size_t>(3); };
+  for (ElfW(Half) i = 0; i < info->dlpi_phnum; ++i)
+  {
+    const ElfW(Phdr) &phdr = info->dlpi_phdr[i];
+    if (phdr.p_type != PT_NOTE) continue;
+    const char *p = reinterpret_cast<const char *>(info->dlpi_addr + phdr.p_vaddr);
+    const char *end = p + phdr.p_memsz;
+    while (p + sizeof(ElfW(Nhdr)) <= end)
+    {
+      const ElfW(Nhdr) *note = reinterpret_cast<const ElfW(Nhdr) *>(p);
+      const char *name = p + sizeof(ElfW(Nhdr));
+      const char *desc = name + align4(note->n_namesz);
+      if (desc + note->n_descsz > end) break;
+      if (note->n_type == NT_GNU_BUILD_ID && note->n_namesz == 4 && std::memcmp(name, "GNU", 4) == 0)
+      {
+        query->id = to_hex(reinterpret_cast<const unsigned char *>(desc), note->n_descsz);
+        return 1;
+      }
+      p = desc + align4(note->n_descsz);
+    }
+  }
+  return 1;  // 找到了模块但没有 build-id
+}
+
+inline std::string image_fingerprint(library_handle handle)
+{
+  struct link_map *map = nullptr;
+  if (dlinfo(handle, RTLD_DI_LINKMAP, &map) != 0 || map == nullptr || map->l_addr == 0) return std::string();
+  build_id_query query{map->l_addr, std::string()};
+  dl_iterate_phdr(find_build_id, &query);
+  return query.id.empty() ? std::string() : "build-id:" + query.id;
+}
+#else
+inline std::string image_fingerprint(library_handle)
+{
+  return std::string();
+}
+#endif
+
+/// @brief 文件标识: 大小 + 修改时间(映像本身没有构建标识时使用)
+inline std::string file_fingerprint(const std::string &path)
+{
+#if defined(_WIN32)
+  WIN32_FILE_ATTRIBUTE_DATA attr;
+  if (!GetFileAttributesExW(widen_path(path).c_str(), GetFileExInfoStandard, &attr)) return std::string();
+  const unsigned long long size = (static_cast<unsigned long long>(attr.nFileSizeHigh) << 32) | attr.nFileSizeLow;
+  const unsigned long long mtime =
+    (static_cast<unsigned long long>(attr.ftLastWriteTime.dwHighDateTime) << 32) | attr.ftLastWriteTime.dwLowDateTime;
+#else
+  struct stat st;
+  if (::stat(path.c_str(), &st) != 0) return std::string();
+  const unsigned long long size = static_cast<unsigned long long>(st.st_size);
+  const unsigned long long mtime = static_cast<unsigned long long>(st.st_mtime);
+#endif
+  return "file:" + std::to_string(size) + ":" + std::to_string(mtime);
+}
+
+// 清单文件格式(本机字节序):
+//   magic[8] | u32 指纹长度 | 指纹 | u32 符号数量 | 每个符号: u32 长度 + 名称
+constexpr char manifest_magic[8] = {'D', 'L', 'L', 'S', 'Y', 'M', 'S', 1};
+constexpr std::uint32_t manifest_max_symbols = 1u << 20;      // 读取时的上限, 防止损坏的文件导致巨量分配
+constexpr std::uint32_t manifest_max_name_length = 1u << 16;  // 单个名称(含修饰名)的长度上限
+
+/// @brief 用 from 替换 to(to 已存在时覆盖), 失败时删除 from
+inline bool replace_file(const std::string &from, const std::string &to) noexcept
+{
+#if defined(_WIN32)
+  try
+  {
+    if (MoveFileExW(widen_path(from).c_str(), widen_path(to).c_str(), MOVEFILE_REPLACE_EXISTING)) return true;
+  }
+  catch (const std::bad_alloc &)
+  {
+  }
+#else
+  if (std::rename(from.c_str(), to.c_str()) == 0) return true;
+#endif
+  remove_file(from);
+  return false;
+}
+
+/// @brief file 同目录下的唯一临时文件名(进程号 + 进程内计数), 并发写入的进程和线程不会共用同一个临时文件
+inline std::string temp_file_name(const std::string &file)
+{
+  static std::atomic<std::uint32_t> counter{0};
+#if defined(_WIN32)
+  const unsigned long pid = GetCurrentProcessId();
+#else
+  const unsigned long pid = static_cast<unsigned long>(::getpid());
+#endif
+  return file + ".tmp." + std::to_string(pid) + "." + std::to_string(counter.fetch_add(1, std::memory_order_relaxed));
+}
+
+inline void write_u32(std::string &out, std::uint32_t value)
+{
+  out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+inline bool read_u32(std::istream &in, std::uint32_t &value)
+{
+  return static_cast<bool>(in.read(reinterpret_cast<char *>(&value), sizeof(value)));
+}
+}  // namespace detail
+
+/**
+ * @brief 动态库构建标识, 用作符号清单的键; 无法确定时返回空字符串
+ *
+ * 依次尝试: ELF GNU build-id(Linux)、PE 时间戳 + 映像大小(Windows)、文件大小 + 修改时间
+ */
+inline std::string library_fingerprint(const dynamic_library &lib)
+{
+  if (!lib.valid()) return std::string();
+  std::string key = detail::image_fingerprint(lib.native_handle());
+  return key.empty() ? detail::file_fingerprint(lib.path()) : key;
+}
+
+/**
+ * @brief 符号清单: 记录进程实际使用过的符号, 下次启动时一次性预解析
+ *
+ *   auto manifest = dll::symbol_manifest::read("plugin.syms");  // 启动: 文件不存在或不匹配时为空
+ *   manifest.prefetch(lib);                                     // 在首次调用之前批量解析
+ *   ...
+ *   dll::symbol_manifest::record(lib).write("plugin.syms");     // 退出(或定期): 保存本次使用的符号
+ */
+class symbol_manifest
+{
+ public:
+  symbol_manifest() = default;
+
+  /// @param fingerprint 动态库构建标识(见 library_fingerprint)
+  /// @param symbols 符号名称列表
+  symbol_manifest(std::string fingerprint, std::vector<std::string> symbols) :
+    fingerprint_(std::move(fingerprint)), symbols_(std::move(symbols))
+  {
+  }
+
+  /// @brief 记录动态库当前已解析的符号(符号缓存中的命中项); 无法确定构建标识时返回空清单
+  static symbol_manifest record(const dynamic_library &lib)
+  {
+    std::string fingerprint = library_fingerprint(lib);
+    if (fingerprint.empty()) return symbol_manifest();
+    return symbol_manifest(std::move(fingerprint), lib.cached_symbols());
+  }
+
+  /// @brief 读取清单文件; 文件不存在、格式不符或已损坏时返回空清单(不会抛出异常)
+  static symbol_manifest read(const std::string &file) noexcept
+  {
+    try
+    {
+      std::ifstream in(file, std::ios::binary);
+      char magic[sizeof(detail::manifest_magic)];
+      if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, detail::manifest_magic, sizeof(magic)) != 0)
+      {
+        return symbol_manifest();
+      }
+      symbol_manifest manifest;
+      std::uint32_t len = 0, count = 0;
+      if (!detail::read_u32(in, len) || len == 0 || len > detail::manifest_max_name_length) return symbol_manifest();
+      manifest.fingerprint_.resize(len);
+      if (!in.read(&manifest.fingerprint_[0], len)) return symbol_manifest();
+      if (!detail::read_u32(in, count) || count > detail::manifest_max_symbols) return symbol_manifest();
+      manifest.symbols_.reserve(count);
+      for (std::uint32_t i = 0; i < count; ++i)
+      {
+        if (!detail::read_u32(in, len) || len == 0 || len > detail::manifest_max_name_length) return symbol_manifest();
+        std::string name(len, '\0');
+        if (!in.read(&name[0], len)) return symbol_manifest();
+        manifest.symbols_.push_back(std::move(name));
+      }
+      return manifest;
+    }
+    catch (...)
+    {
+      return symbol_manifest();
+    }
+  }
+
+  /**
+   * @brief 写入清单文件: 先写唯一的临时文件再重命名, 并发启动的进程不会读到写了一半的文件
+   * @return 写入成功返回 true; 空清单不写入并返回 false
+   */
+  bool write(const std::string &file) const
+  {
+    if (empty()) return false;
+    std::string data(detail::manifest_magic, sizeof(detail::manifest_magic));
+    detail::write_u32(data, static_cast<std::uint32_t>(fingerprint_.size()));
+    data += fingerprint_;
+    detail::write_u32(data, static_cast<std::uint32_t>(symbols_.size()));
+    for (const auto &name : symbols_)
+    {
+      detail::write_u32(data, static_cast<std::uint32_t>(name.size()));
+      data += name;
+    }
+
+    const std::string tmp = detail::temp_file_name(file);
+    {
+      std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+      if (!out.write(data.data(), static_cast<std::streamsize>(data.size())) || !out.flush())
+      {
+        detail::remove_file(tmp);
+        return false;
+      }
+    }
+    return detail::replace_file(tmp, file);
+  }
+
+  /// @brief 清单是否属于当前加载的动态库构建
+  bool matches(const dynamic_library &lib) const
+  {
+    return !fingerprint_.empty() && fingerprint_ == library_fingerprint(lib);
+  }
+
+  /**
+   * @brief 批量预解析清单中的符号(见 dynamic_library::warm_up), 清单与动态库构建不匹配时什么也不做
+   * @return 解析成功的符号数量
+   */
+  std::size_t prefetch(const dynamic_library &lib) const
+  {
+    if (symbols_.empty() || !matches(lib)) return 0;
+    return symbols_.size() - lib.warm_up(symbols_);
+  }
+
+  /// @brief 动态库构建标识
+  const std::string &fingerprint() const noexcept
+  {
+    return fingerprint_;
+  }
+
+  /// @brief 符号名称列表
+  const std::vector<std::string> &symbols() const noexcept
+  {
+    return symbols_;
+  }
+
+  /// @brief 是否为空清单(没有构建标识或没有符号)
+  bool empty() const noexcept
+  {
+    return fingerprint_.empty() || symbols_.empty();
+  }
+
+ private:
+  std::string fingerprint_;           // 动态库构建标识
+  std::vector<std::string> symbols_;  // 符号名称列表
+};
+
+/**
+ * @brief 在后台线程预解析清单中的符号, 调用者可以继续初始化其他模块
+ * @param lib 动态库, 必须在返回的 future 完成之前保持有效(future 析构时会等待任务结束)
+ * @param manifest 符号清单
+ * @return 解析成功的符号数量的 future
+ */
+inline std::future<std::size_t> prefetch_async(const dynamic_library &lib, symbol_manifest manifest)
+{
+  return std::async(std::launch::async, [&lib, manifest] { return manifest.prefetch(lib); });
+}
+
+}  // namespace dll
+
+#endif  // DYNAMIC_LIBRARY_SYMBOL_MANIFEST_H
@@ -1,7 +1,21 @@
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <iterator>
 #include <string>
+#include <vector>
 
+#include "dynamic_library/async_loader.hpp"
+#include "dynamic_library/awaitable.hpp"
+#include "dynamic_library/cpu_dispatch.hpp"
 #include "dynamic_library/dynamic_library.hpp"
+#include "dynamic_library/hot_reload.hpp"
+#include "dynamic_library/library_registry.hpp"
+#include "dynamic_library/plugin_scan.hpp"
+#include "dynamic_library/sandbox.hpp"
+#include "dynamic_library/symbol_manifest.hpp"
 
 /*
  * 为了在没有头文件的情况下调用 libdynamic.so 中的内容，你需要使用 动态链接库的运行时加载机制，
@@ -29,6 +43,33 @@ struct box_t
   point_t max;    // 最大点
 };
 
+// SoA 布局的点集合与 box 集合(内存由动态库的 point_soa_* / box_soa_* 函数分配和释放)
+struct point_soa_t
+{
+  double *x;
+  double *y;
+  double *z;
+  size_t size;
+  size_t capacity;
+};
+
+struct box_soa_t
+{
+  int *id;
+  char (*name)[64];
+  point_soa_t min;
+  point_soa_t max;
+  size_t size;
+  size_t capacity;
+};
+
+// 快速格式化接口的返回值
+struct format_result_t
+{
+  size_t length;
+  int truncated;  // 1: 空间不足已截断(包括没有缓冲), -1: 要格式化的对象为空
+};
+
 using getPoint_func = point_t (*)();
 using printPoint_func = void (*)(point_t);
 
@@ -36,6 +77,32 @@ using printPoint_func = void (*)(point_t);
 typedef void (*double_callback_t)(double x, double y, double z);  // 简单函数回调
 typedef void (*point_callback_t)(point_t p);                      // 按值传递 point_t
 typedef void (*box_callback_t)(box_t *p);                         // 指针传递 box_t
+
+typedef void (*point_batch_callback_t)(const point_t *points, unsigned int count);  // 批量回调: point_t 数组
+typedef void (*box_batch_callback_t)(const box_t *boxes, unsigned int count);       // 批量回调: box_t 数组
+
+// 符号表: 一次性描述动态库导出的一组函数, 通过 load_table 一次加载
+#define DYNAMIC_API(X)                  \
+  X(sayHello, void())                   \
+  X(intAdd, int(int, int))              \
+  X(floatAdd, float(float, float))      \
+  X(doubleAdd, double(double, double))  \
+  X(getPoint, point_t())                \
+  X(printPoint, void(point_t))
+DLL_SYMBOL_TABLE(dynamic_api, DYNAMIC_API)
+
+// 插件描述符: 与 dynamic.h 中 dynamic_plugin_t 开头的成员相同(只声明用到的前缀, 插件端可以更大)
+struct dynamic_plugin
+{
+  dll::plugin_abi abi;
+  const char *version;
+  void (*sayHello)();
+  int (*intAdd)(int a, int b);
+  float (*floatAdd)(float a, float b);
+  double (*doubleAdd)(double a, double b);
+  point_t (*getPoint)();
+  void (*printPoint)(point_t arg);
+};
 /// =========== 定义动态库中函数指针类型 end ===========
 
 void func();
@@ -44,7 +111,29 @@ void testGetVariable(const dll::dynamic_library &lib);
 void testGetVariable2(const dll::dynamic_library &lib);
 void testNotExistSymbol(const dll::dynamic_library &lib);
 void testCallback(const dll::dynamic_library &lib);
+void testBatchCallback(const dll::dynamic_library &lib);
+void testBatchMath(const dll::dynamic_library &lib);
+void testSoa(const dll::dynamic_library &lib);
+void testFormat(const dll::dynamic_library &lib);
 void testNullLibrary();
+void testCacheMode(const std::string &libPath);
+void testBind(const std::string &libPath);
+void testSymbolTable(const dll::dynamic_library &lib);
+void testPluginDescriptor(const dll::dynamic_library &lib);
+void testExportIndex(const std::string &libPath);
+void testLoadOptions(const std::string &libPath);
+void testLazyLoad(const std::string &libPath);
+void testAsyncLoad(const std::string &libPath);
+void testAwaitable(const dll::dynamic_library &lib);
+void testRegistry(const std::string &libPath);
+void testHotReload(const std::string &libPath);
+void testInstrumentation(const std::string &libPath);
+void testTrace(const std::string &libPath);
+void testCpuDispatch(const std::string &libPath);
+void testLoadFromMemory(const std::string &libPath);
+void testSymbolManifest(const std::string &libPath);
+void testSandbox(const std::string &libPath);
+void testPluginScan(const std::string &libPath);
 int main()
 {
   std::cout << "====================================================" << std::endl;
@@ -129,6 +218,30 @@ void func()
     testNullLibrary();
     testNotExistSymbol(lib);
     testCallback(lib);
+    testBatchCallback(lib);
+    testBatchMath(lib);
+    testSoa(lib);
+    testFormat(lib);
+    testCacheMode(libPath);
+    testBind(libPath);
+    testSymbolTable(lib);
+    testPluginDescriptor(lib);
+    testExportIndex(libPath);
+    testLoadOptions(libPath);
+    testLazyLoad(libPath);
+    testAsyncLoad(libPath);
+    testAwaitable(lib);
+    testRegistry(libPath);
+    testHotReload(libPath);
+    testInstrumentation(libPath);
+    testTrace(libPath);
+    testCpuDispatch(libPath);
+    testLoadFromMemory(libPath);
+    testSymbolManifest(libPath);
+    testSandbox(libPath);
+    testPluginScan(libPath);
+
+    lib.invoke<void()>("shutdown_log");  // 卸载动态库前写出剩余日志并结束日志线程
   }
   catch (const std::exception &ex)
   {
@@ -175,6 +288,8 @@ void testHasSymbol(const dll::dynamic_library &lib)
   std::cout << "has_symbol(\"g_point_ptr\"): " << lib.has_symbol("g_point_ptr") << std::endl;
   std::cout << "has_symbol(\"g_point_ptr\"): " << lib.has_symbol("g_point_ptr") << std::endl;
   std::cout << "has_symbol(\"g_point_ptr0\"): " << lib.has_symbol("g_point_ptr1") << std::endl;
+  // 不存在的符号也会被缓存(否定缓存), 重复查询不再经过 dlsym/GetProcAddress
+  std::cout << "has_symbol(\"g_point_ptr1\"): " << lib.has_symbol("g_point_ptr1") << std::endl;
 
   std::cout << "------ testHasSymbol ------" << std::endl;
 }
@@ -316,6 +431,9 @@ typedef void (*double_callback_t)(double x, double y, double z);  // 简单函
 typedef void (*point_callback_t)(point_t p);                      // 按值传递 point_t
 typedef void (*box_callback_t)(box_t *p);                         // 指针传递 box_t
 
+typedef void (*point_batch_callback_t)(const point_t *points, unsigned int count);  // 批量回调: point_t 数组
+typedef void (*box_batch_callback_t)(const box_t *boxes, unsigned int count);       // 批量回调: box_t 数组
+
 /// 自定义的回调函数
 void my_double_callback(double x, double y, double z)
 {
@@ -371,4 +489,591 @@ void testCallback(const dll::dynamic_library &lib)
   fn_trigger_callbacks(4);
 
   std::cout << "---------testCallback----------" << std::endl;
-}
\ No newline at end of file
+}
+
+/// @brief 测试批量回调: 一次回调接收一组事件, 减少逐个事件的间接调用开销
+void testBatchCallback(const dll::dynamic_library &lib)
+{
+  std::cout << "---------testBatchCallback----------" << std::endl;
+  static unsigned int point_batches = 0, point_events = 0, box_events = 0;
+  static double x_sum = 0;
+  point_batch_callback_t on_points = [](const point_t *points, unsigned int n) {
+    ++point_batches;
+    point_events += n;
+    for (unsigned int i = 0; i < n; ++i) x_sum += points[i].x;
+  };
+  box_batch_callback_t on_boxes = [](const box_t *boxes, unsigned int n) {
+    box_events += n;
+    if (n > 0) std::cout << "[box batch] first: " << boxes[0].id << " '" << boxes[0].name << "'" << std::endl;
+  };
+  lib.invoke<void(point_batch_callback_t)>("register_point_batch_callback", on_points);
+  lib.invoke<void(box_batch_callback_t)>("register_box_batch_callback", on_boxes);
+
+  lib.invoke<void(int, unsigned int)>("trigger_callbacks_batch", 2 | 4, 1000u);
+  std::cout << "point events: " << point_events << " in " << point_batches << " batches, sum(x) = " << x_sum
+            << std::endl;
+  std::cout << "box events: " << box_events << std::endl;
+  std::cout << "---------testBatchCallback----------" << std::endl;
+}
+
+/// @brief 测试批量(SIMD)接口: 一次调用处理整个数组, 代替逐个元素跨越动态库边界
+void testBatchMath(const dll::dynamic_library &lib)
+{
+  std::cout << "---------testBatchMath----------" << std::endl;
+  const double a[5] = {1, 2, 3, 4, 5};
+  const double b[5] = {0.5, 0.5, 0.5, 0.5, 0.5};
+  double sum[5] = {};
+  lib.invoke<void(const double *, const double *, double *, size_t)>("doubleAddN", a, b, sum, size_t(5));
+  std::cout << "doubleAddN:";
+  for (double v : sum) std::cout << " " << v;
+  std::cout << std::endl;
+
+  point_t points[3] = {{1, 2, 3}, {4, 5, 6}, {7, 8, 9}};
+  const point_t offset = {100, 200, 300};
+  auto transform = lib.get<void(const point_t *, point_t *, size_t, double, point_t)>("transformPoints");
+  transform(points, points, 3, 2.0, offset);  // 原地计算: p = p * 2 + offset
+  for (const auto &p : points)
+  {
+    std::cout << "transformPoints: (" << p.x << ", " << p.y << ", " << p.z << ")" << std::endl;
+  }
+  std::cout << "---------testBatchMath----------" << std::endl;
+}
+
+/// @brief 测试 SoA 点集合: 由动态库分配对齐内存, 调用者直接读写分量数组, 不需要在 AoS/SoA 之间重排
+void testSoa(const dll::dynamic_library &lib)
+{
+  std::cout << "---------testSoa----------" << std::endl;
+  point_soa_t soa;
+  if (lib.invoke<int(point_soa_t *, size_t)>("point_soa_init", &soa, size_t(1000)) != 0) return;
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    soa.x[i] = static_cast<double>(i);
+    soa.y[i] = static_cast<double>(i) * 2;
+    soa.z[i] = -static_cast<double>(i);
+  }
+  soa.size = 1000;
+  const point_t offset = {1, 1, 1};
+  lib.invoke<void(const point_soa_t *, point_soa_t *, double, point_t)>("transformPointsSoa", &soa, &soa, 0.5, offset);
+  point_t min, max;
+  lib.invoke<int(const point_soa_t *, point_t *, point_t *)>("boundsPointsSoa", &soa, &min, &max);
+  std::cout << "capacity: " << soa.capacity << ", bounds: (" << min.x << ", " << min.y << ", " << min.z << ") - ("
+            << max.x << ", " << max.y << ", " << max.z << ")" << std::endl;
+
+  box_soa_t boxes;
+  box_t box = lib.invoke<box_t()>("getBox");
+  lib.invoke<int(box_soa_t *, size_t)>("box_soa_init", &boxes, size_t(1));
+  lib.invoke<size_t(box_soa_t *, const box_t *, size_t)>("box_soa_from_aos", &boxes, &box, size_t(1));
+  std::cout << "box_soa: id = " << boxes.id[0] << ", name = " << boxes.name[0] << ", min.x = " << boxes.min.x[0]
+            << std::endl;
+  lib.invoke<void(box_soa_t *)>("box_soa_free", &boxes);
+  lib.invoke<void(point_soa_t *)>("point_soa_free", &soa);
+  std::cout << "---------testSoa----------" << std::endl;
+}
+
+/// @brief 测试快速格式化接口: 返回写入长度和是否截断; 批量接口空间不足时从已格式化的位置继续
+void testFormat(const dll::dynamic_library &lib)
+{
+  std::cout << "---------testFormat----------" << std::endl;
+  box_t box = lib.invoke<box_t()>("getBox");
+  char small[32];
+  auto r = lib.invoke<format_result_t(const box_t *, char *, size_t)>("box2Chars", &box, small, sizeof(small));
+  std::cout << "box2Chars: \"" << small << "\" length = " << r.length << ", truncated = " << r.truncated << std::endl;
+
+  const point_t points[5] = {{1, 2, 3}, {4, 5, 6}, {7, 8, 9}, {10, 11, 12}, {13, 14, 15}};
+  auto points2Chars = lib.get<format_result_t(const point_t *, size_t, char *, size_t, size_t *)>("points2Chars");
+  char buf[128];  // 一次最多容纳 2 行, 分多次格式化
+  for (size_t begin = 0; begin < 5;)
+  {
+    size_t formatted = 0;
+    r = points2Chars(points + begin, 5 - begin, buf, sizeof(buf), &formatted);
+    std::cout << "points2Chars: " << formatted << " points, " << r.length << " chars" << std::endl << buf;
+    if (formatted == 0) break;  // 缓冲连一行都放不下
+    begin += formatted;
+  }
+  std::cout << "---------testFormat----------" << std::endl;
+}
+
+/// @brief 测试无锁符号缓存模式: 缓存命中不加锁, 适合多线程高频调用 invoke()
+void testCacheMode(const std::string &libPath)
+{
+  std::cout << "---------testCacheMode----------" << std::endl;
+  dll::dynamic_library lib(libPath, dll::cache_mode::lock_free);
+  int sum = 0;
+  for (int i = 1; i <= 100; ++i)
+  {
+    sum = lib.invoke<int(int, int)>("intAdd", sum, i);  // 第一次未命中会加锁写缓存, 之后命中无锁
+  }
+  std::cout << "lock_free invoke: sum(1..100) = " << sum << std::endl;
+  std::cout << "has_symbol(\"intAdd\"): " << lib.has_symbol("intAdd") << std::endl;
+  lib.has_symbol("notExistFunc");
+  std::cout << "cache entries: " << lib.cache_size() << ", heap bytes: " << lib.cache_memory_usage() << std::endl;
+
+  // 线程本地缓存: 每个线程的热点符号从私有缓存命中, 重新加载后缓存代数更换, 旧的线程缓存项自动失效
+  dll::load_options opts;
+  opts.cache = dll::cache_mode::thread_local_tier;
+  dll::dynamic_library tls(libPath, opts);
+  std::cout << "thread_local_tier invoke: intAdd(1, 2) = " << tls.invoke<int(int, int)>("intAdd", 1, 2);
+  tls.load(libPath, opts);
+  std::cout << ", after reload: intAdd(3, 4) = " << tls.invoke<int(int, int)>("intAdd", 3, 4) << std::endl;
+  std::cout << "---------testCacheMode----------" << std::endl;
+}
+
+/// @brief 测试绑定符号句柄: 只解析一次, 卸载或重新加载后句柄自动失效
+void testBind(const std::string &libPath)
+{
+  std::cout << "---------testBind----------" << std::endl;
+  dll::dynamic_library lib(libPath);
+  auto intAdd = lib.bind<int(int, int)>("intAdd");  // 绑定一次, 之后调用不再查找符号
+  std::cout << "bind: intAdd(20, 22) = " << intAdd(20, 22) << std::endl;
+
+  auto notExist = lib.try_bind<void()>("notExistFunc");  // 加载失败不抛异常, 返回空句柄
+  std::cout << "try_bind(\"notExistFunc\") valid: " << notExist.valid() << std::endl;
+
+  lib.load(libPath);  // 重新加载后旧句柄失效
+  std::cout << "after reload, intAdd valid: " << intAdd.valid() << std::endl;
+  try
+  {
+    intAdd(1, 2);  // 调用过期句柄抛出异常
+  }
+  catch (const std::exception &e)
+  {
+    std::cerr << e.what() << '\n';
+  }
+  std::cout << "---------testBind----------" << std::endl;
+}
+
+// 含有不存在符号的符号表, 用于演示统一的错误报告
+#define BROKEN_API(X)      \
+  X(intAdd, int(int, int)) \
+  X(notExistFunc, void())  \
+  X(notExistFunc2, void())
+DLL_SYMBOL_TABLE(broken_api, BROKEN_API)
+
+/// @brief 测试符号表: 一次性加载整组函数符号, 之后直接通过结构体成员调用
+void testSymbolTable(const dll::dynamic_library &lib)
+{
+  std::cout << "---------testSymbolTable----------" << std::endl;
+  dynamic_api api = lib.load_table<dynamic_api>();
+  api.sayHello();
+  std::cout << "api.intAdd(1, 2) = " << api.intAdd(1, 2) << std::endl;
+  std::cout << "api.doubleAdd(1.5, 2.5) = " << api.doubleAdd(1.5, 2.5) << std::endl;
+  point_t p = api.getPoint();
+  std::cout << "api.printPoint() output: ";
+  api.printPoint(p);
+  std::cout << std::endl;
+
+  try
+  {
+    lib.load_table<broken_api>();  // 缺失的符号会在一个异常中统一报告
+  }
+  catch (const std::exception &e)
+  {
+    std::cerr << e.what() << '\n';
+  }
+  std::cout << "---------testSymbolTable----------" << std::endl;
+}
+
+/// @brief 测试插件描述符: 只查找一个入口, 校验 ABI 版本和结构体布局后直接通过函数指针调用
+void testPluginDescriptor(const dll::dynamic_library &lib)
+{
+  std::cout << "---------testPluginDescriptor----------" << std::endl;
+  const dynamic_plugin &plugin =
+    lib.load_descriptor<dynamic_plugin>(1, {DLL_PLUGIN_LAYOUT(point_t), DLL_PLUGIN_LAYOUT(box_t)});
+  std::cout << "plugin version: " << plugin.version << ", abi: " << plugin.abi.abi_version
+            << ", descriptor size: " << plugin.abi.descriptor_size << ", features: 0x" << std::hex
+            << plugin.abi.features << std::dec << std::endl;
+  std::cout << "plugin.intAdd(1, 2) = " << plugin.intAdd(1, 2) << std::endl;
+  std::cout << "plugin.printPoint() output: ";
+  plugin.printPoint(plugin.getPoint());
+  std::cout << std::endl;
+
+  // 布局不一致(例如宿主按 2D 点编译)在调用之前就会被拒绝
+  try
+  {
+    const dll::plugin_layout point2d{"point_t", 16, 8}, widget{"widget_t", 4, 4};
+    lib.load_descriptor<dynamic_plugin>(1, {point2d, widget});
+  }
+  catch (const std::exception &e)
+  {
+    std::cerr << e.what() << '\n';
+  }
+  std::cout << "---------testPluginDescriptor----------" << std::endl;
+}
+
+/// @brief 测试导出表索引: 加载时一次性解析导出表, 之后的存在性检查不再经过系统加载器
+void testExportIndex(const std::string &libPath)
+{
+  std::cout << "---------testExportIndex----------" << std::endl;
+  dll::dynamic_library lib(libPath);
+  bool indexed = lib.enable_export_index();  // 平台不支持时返回 false, 自动回退到 dlsym/GetProcAddress
+  std::cout << "export index enabled: " << indexed << std::endl;
+  std::cout << "has_symbol(\"intAdd\"): " << lib.has_symbol("intAdd") << std::endl;
+  std::cout << "has_symbol(\"notExistFunc\"): " << lib.has_symbol("notExistFunc") << std::endl;
+  std::cout << "exports:";
+  for (const auto &name : lib.exports())
+  {
+    if (name.compare(0, 2, "_Z") != 0) std::cout << " " << name;  // 跳过 C++ 修饰名
+  }
+  std::cout << std::endl;
+  std::cout << "---------testExportIndex----------" << std::endl;
+}
+
+/// @brief 测试加载选项: 立即绑定 + 预热符号, 把绑定与查找开销全部提前到启动阶段
+void testLoadOptions(const std::string &libPath)
+{
+  std::cout << "---------testLoadOptions----------" << std::endl;
+  dll::load_options opts;
+#if !defined(_WIN32) && !defined(_WIN64)
+  opts.flags = RTLD_NOW | RTLD_LOCAL;  // 立即绑定, 避免首次调用时的延迟绑定开销
+#endif
+  opts.cache = dll::cache_mode::lock_free;
+  opts.warmup = {"intAdd", "doubleAdd", "getPoint", "notExistFunc"};
+  dll::dynamic_library lib(libPath, opts);
+  std::cout << "warm_up missing count: " << lib.warm_up({"intAdd", "notExistFunc"}) << std::endl;
+  std::cout << "invoke: intAdd(3, 4) = " << lib.invoke<int(int, int)>("intAdd", 3, 4) << std::endl;  // 直接命中缓存
+  std::cout << "---------testLoadOptions----------" << std::endl;
+}
+
+/// @brief 测试延迟加载: 构造时只记录路径, 第一次使用时才加载; 不使用的可选插件不产生加载开销
+void testLazyLoad(const std::string &libPath)
+{
+  std::cout << "---------testLazyLoad----------" << std::endl;
+  dll::load_options opts;
+  opts.lazy = true;
+  opts.warmup = {"intAdd"};  // 在首次使用加载完成后预热
+  dll::dynamic_library lib(libPath, opts);
+  dll::dynamic_library unused("./not_exist_plugin.so", opts);  // 从不使用: 不会加载, 也不会报错
+  std::cout << "pending: " << lib.pending() << ", valid: " << lib.valid() << std::endl;
+  std::cout << "first use: intAdd(1, 2) = " << lib.invoke<int(int, int)>("intAdd", 1, 2) << std::endl;
+  std::cout << "pending: " << lib.pending() << ", valid: " << lib.valid() << std::endl;
+
+  dll::dynamic_library missing("./not_exist_plugin.so", opts);
+  std::cout << "missing plugin has_symbol: " << missing.has_symbol("intAdd") << std::endl;  // noexcept 接口返回 false
+  try
+  {
+    missing.invoke<int(int, int)>("intAdd", 1, 2);  // 抛出首次加载时的异常
+  }
+  catch (const std::exception &e)
+  {
+    std::cerr << e.what() << '\n';
+  }
+  std::cout << "---------testLazyLoad----------" << std::endl;
+}
+
+/// @brief 测试异步/并发加载: 多个动态库在线程池上并发加载, 每个库单独报告结果
+void testAsyncLoad(const std::string &libPath)
+{
+  std::cout << "---------testAsyncLoad----------" << std::endl;
+  std::future<dll::dynamic_library> fut = dll::load_async(libPath);  // 后台加载, 主线程可以继续做别的事
+  dll::dynamic_library lib = fut.get();                              // 加载失败时这里抛出异常
+  std::cout << "load_async: intAdd(5, 6) = " << lib.invoke<int(int, int)>("intAdd", 5, 6) << std::endl;
+
+  std::vector<dll::load_result> results = dll::load_all({libPath, "./not_exist_lib.so", libPath});
+  for (const auto &r : results)
+  {
+    std::cout << "load_all: " << r.path << " -> " << (r.ok() ? "ok" : r.error) << std::endl;
+  }
+  std::cout << "---------testAsyncLoad----------" << std::endl;
+}
+
+#ifdef DLL_HAS_COROUTINES
+/// @brief 演示用的最小协程类型: 立即开始执行, 结束时通过 std::future 通知
+struct demo_task
+{
+  struct promise_type
+  {
+    std::promise<void> done;
+    demo_task get_return_object()
+    {
+      return demo_task{done.get_future()};
+    }
+    std::suspend_never initial_suspend() noexcept
+    {
+      return {};
+    }
+    std::suspend_never final_suspend() noexcept
+    {
+      return {};
+    }
+    void return_void()
+    {
+      done.set_value();
+    }
+    void unhandled_exception()
+    {
+      done.set_exception(std::current_exception());
+    }
+  };
+  std::future<void> finished;
+};
+
+/// @brief 在线程池上执行插件调用, 协程挂起期间不占用调用线程
+demo_task awaitPluginCalls(dll::thread_pool &pool, const dll::dynamic_library &lib)
+{
+  auto add = lib.bind<int(int, int)>("intAdd");
+  int sum = co_await dll::async_call(pool, add, 20, 22);
+  std::cout << "co_await async_call(intAdd, 20, 22) = " << sum << std::endl;
+  auto getPoint = lib.bind<point_t()>("getPoint");
+  point_t p = co_await dll::async_call(pool, getPoint);
+  std::cout << "co_await async_call(getPoint) = {" << p.x << ", " << p.y << ", " << p.z << "}" << std::endl;
+}
+#endif
+
+/// @brief 测试协程调用(C++20): 把阻塞的插件调用放到线程池执行, 完成后恢复协程
+void testAwaitable(const dll::dynamic_library &lib)
+{
+  std::cout << "---------testAwaitable----------" << std::endl;
+#ifdef DLL_HAS_COROUTINES
+  dll::thread_pool pool(2);
+  awaitPluginCalls(pool, lib).finished.get();
+#else
+  (void)lib;
+  std::cout << "coroutines not available in this build (requires C++20)" << std::endl;
+#endif
+  std::cout << "---------testAwaitable----------" << std::endl;
+}
+
+/// @brief 测试进程级共享注册表: 同一路径只加载一次, 所有使用者共享同一句柄和符号缓存
+void testRegistry(const std::string &libPath)
+{
+  std::cout << "---------testRegistry----------" << std::endl;
+  dll::library_registry &registry = dll::library_registry::instance();
+  {
+    dll::library_registry::library_ptr a = registry.acquire(libPath);        // 第一次 acquire 时加载
+    dll::library_registry::library_ptr b = registry.acquire("./" + libPath);  // 不同写法的同一路径, 共享实例
+    std::cout << "same instance: " << std::boolalpha << (a == b) << ", use_count = " << a.use_count() << std::endl;
+    std::cout << "a intAdd(7, 8) = " << a->invoke<int(int, int)>("intAdd", 7, 8) << std::endl;
+    std::cout << "b intAdd(9, 1) = " << b->invoke<int(int, int)>("intAdd", 9, 1) << std::endl;  // a 已缓存该符号
+    std::cout << "live libraries: " << registry.size() << std::endl;
+  }
+  std::cout << "after release, live libraries: " << registry.size() << std::endl;  // 最后一个引用释放后已卸载
+  std::cout << "find after release: " << (registry.find(libPath) ? "found" : "nullptr") << std::endl;
+  std::cout << "---------testRegistry----------" << std::endl;
+}
+
+/// @brief 测试热更新: 新版本与旧版本并存, 已固定旧版本的调用者不受 reload 影响
+void testHotReload(const std::string &libPath)
+{
+  std::cout << "---------testHotReload----------" << std::endl;
+  // 模拟发布新版本: 新版本必须是另一个文件, 同一路径系统加载器会直接返回已加载的模块
+  const std::string newPath = libPath + ".v2";
+  {
+    std::ifstream src(libPath, std::ios::binary);
+    std::ofstream dst(newPath, std::ios::binary);
+    dst << src.rdbuf();
+  }
+
+  dll::hot_library<dynamic_api> plugin(libPath);
+  {
+    auto pinned = plugin.pin();  // 固定版本 1
+    std::cout << "reload -> version " << plugin.reload(newPath) << std::endl;
+    std::cout << "pinned version " << pinned.version_number() << ": intAdd(1, 2) = " << pinned->intAdd(1, 2)
+              << std::endl;  // 旧版本仍然有效
+    std::cout << "pending old versions: " << plugin.reclaim() << std::endl;
+  }
+  std::cout << "pending old versions after unpin: " << plugin.reclaim() << std::endl;
+  std::cout << "current version " << plugin.version_number() << ": intAdd(3, 4) = "
+            << plugin.with([](const dynamic_api &api) { return api.intAdd(3, 4); }) << std::endl;
+
+  try
+  {
+    plugin.reload("./not_exist_lib.so");  // 加载失败时旧版本继续服务
+  }
+  catch (const std::exception &e)
+  {
+    std::cout << "reload failed, still version " << plugin.version_number() << std::endl;
+  }
+  std::remove(newPath.c_str());
+  std::cout << "---------testHotReload----------" << std::endl;
+}
+
+/// @brief 测试调用统计: 需定义 DLL_ENABLE_INSTRUMENTATION (cmake -DDYNAMIC_LIBRARY_INSTRUMENTATION=ON)
+void testInstrumentation(const std::string &libPath)
+{
+  std::cout << "---------testInstrumentation----------" << std::endl;
+#ifdef DLL_ENABLE_INSTRUMENTATION
+  dll::dynamic_library lib(libPath);
+  auto add = lib.bind<double(double, double)>("doubleAdd");
+  for (int i = 0; i < 1000; ++i)
+  {
+    lib.invoke<int(int, int)>("intAdd", i, i);
+    add(i, 0.5);
+  }
+  std::cout << lib.call_stats_report();
+#else
+  (void)libPath;
+  std::cout << "instrumentation disabled, build with -DDYNAMIC_LIBRARY_INSTRUMENTATION=ON" << std::endl;
+#endif
+  std::cout << "---------testInstrumentation----------" << std::endl;
+}
+
+/// @brief 测试加载器跟踪: 回调报告 load/unload 耗时以及每次符号查找(缓存命中/解析)的耗时
+void testTrace(const std::string &libPath)
+{
+  std::cout << "---------testTrace----------" << std::endl;
+  // 在第一次设置回调之前创建, 进程退出(静态析构)时才卸载: 卸载事件仍会发给退出时安装的回调
+  static dll::dynamic_library early(libPath);
+  static const char *const type_names[] = {"load", "unload", "cache_hit", "resolve"};
+  dll::set_trace_callback([](const dll::trace_event &e, void *) {
+    std::cout << "trace: " << type_names[static_cast<int>(e.type)] << " " << e.path;
+    if (e.symbol) std::cout << " '" << std::string(e.symbol, e.symbol_len) << "'";
+    std::cout << (e.success ? " ok" : " failed") << std::endl;  // 耗时 e.duration_ns 每次运行不同, 这里不打印
+  });
+  {
+    dll::dynamic_library lib(libPath);
+    lib.invoke<int(int, int)>("intAdd", 1, 2);  // 首次: resolve
+    lib.invoke<int(int, int)>("intAdd", 3, 4);  // 再次: cache_hit
+    lib.has_symbol("notExistFunc");
+  }
+  dll::set_trace_callback(nullptr);  // 关闭跟踪
+
+  // 只计数的回调一直保留到进程退出, early 在静态析构阶段卸载时回调它(回调对象不会被释放)
+  static std::atomic<unsigned> exit_events{0};
+  dll::set_trace_callback([](const dll::trace_event &, void *) { exit_events.fetch_add(1); });
+  std::cout << "early library outlives the first callback: " << (early ? "loaded" : "not loaded") << std::endl;
+  std::cout << "---------testTrace----------" << std::endl;
+}
+
+/// @brief 测试按 CPU 特性选择版本: 优先加载特性要求最多且能运行的构建版本, 不存在的版本自动跳过
+void testCpuDispatch(const std::string &libPath)
+{
+  std::cout << "---------testCpuDispatch----------" << std::endl;
+  const dll::cpu_feature_set host = dll::host_cpu_features();
+  std::cout << "host cpu features: " << dll::cpu_feature_names(host) << std::endl;
+
+  // 演示环境只有基线版本, AVX-512/AVX2 版本的文件不存在, 加载失败后回退到下一个可运行的版本
+  dll::dynamic_library lib = dll::load_best_variant({{libPath + ".x86-64-v4", dll::cpu_feature::x86_64_v4},
+                                                     {libPath + ".x86-64-v3", dll::cpu_feature::x86_64_v3},
+                                                     {libPath, dll::cpu_feature::none}});
+  std::cout << "loaded variant: " << lib.path() << std::endl;
+
+  // 同一动态库内按特性选择实现, 不存在的符号被跳过
+  auto add = dll::bind_best<void(const double *, const double *, double *, size_t)>(
+    lib, {{"doubleAddN_avx512", dll::cpu_feature::avx512f}, {"doubleAddN", dll::cpu_feature::none}});
+  const double a[2] = {1, 2}, b[2] = {10, 20};
+  double out[2] = {};
+  add(a, b, out, 2);
+  std::cout << "bind_best doubleAddN: " << out[0] << " " << out[1] << std::endl;
+  std::cout << "---------testCpuDispatch----------" << std::endl;
+}
+
+/// @brief 测试从内存加载: 映像来自网络/制品仓库时不需要先写入磁盘(这里用读入内存的动态库文件模拟)
+void testLoadFromMemory(const std::string &libPath)
+{
+  std::cout << "---------testLoadFromMemory----------" << std::endl;
+  std::ifstream in(libPath, std::ios::binary);
+  std::vector<char> image((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  std::cout << "image size: " << image.size() << " bytes" << std::endl;
+
+  dll::dynamic_library lib;
+  lib.load_from_memory(image.data(), image.size(), dll::load_options(), "libdynamic");
+  image.clear();  // 加载后映像内存即可释放
+  std::cout << "path: " << lib.path() << ", intAdd(20, 22) = " << lib.invoke<int(int, int)>("intAdd", 20, 22)
+            << std::endl;
+
+  try
+  {
+    const char garbage[] = "not a shared library";
+    dll::dynamic_library bad;
+    bad.load_from_memory(garbage, sizeof(garbage), dll::load_options(), "garbage");
+  }
+  catch (const std::exception &e)
+  {
+    std::cout << "invalid image rejected: " << (std::strstr(e.what(), "memory:garbage") ? "yes" : "no") << std::endl;
+  }
+  std::cout << "---------testLoadFromMemory----------" << std::endl;
+}
+
+/// @brief 测试符号清单: 第一次运行记录实际使用的符号, "重启"后在首次调用之前批量预解析
+void testSymbolManifest(const std::string &libPath)
+{
+  std::cout << "---------testSymbolManifest----------" << std::endl;
+  const std::string file = "libdynamic.syms";
+  {
+    dll::dynamic_library lib(libPath);  // 第一次运行: 正常使用
+    lib.invoke<int(int, int)>("intAdd", 1, 2);
+    lib.invoke<double(double, double)>("doubleAdd", 1.0, 2.0);
+    lib.has_symbol("notExistFunc");  // 否定项不会写入清单
+    dll::symbol_manifest manifest = dll::symbol_manifest::record(lib);
+    std::cout << "fingerprint: " << manifest.fingerprint() << std::endl;
+    std::cout << "recorded " << manifest.symbols().size() << " symbols, written: " << manifest.write(file) << std::endl;
+  }
+
+  dll::dynamic_library lib(libPath);  // 再次启动: 后台预解析, 同时可以继续其他初始化
+  std::future<std::size_t> prefetched = dll::prefetch_async(lib, dll::symbol_manifest::read(file));
+  std::cout << "prefetched " << prefetched.get() << " symbols, cache entries: " << lib.cache_size() << std::endl;
+  std::cout << "intAdd(20, 22) = " << lib.invoke<int(int, int)>("intAdd", 20, 22) << std::endl;
+  std::remove(file.c_str());
+  std::cout << "---------testSymbolManifest----------" << std::endl;
+}
+
+/// @brief 测试进程外执行: 插件在子进程中运行, 参数/返回值/缓冲区经共享内存传递, 插件崩溃不影响宿主
+void testSandbox(const std::string &libPath)
+{
+  std::cout << "---------testSandbox----------" << std::endl;
+#ifdef DLL_HAS_SANDBOX
+  dll::sandboxed_library sb(libPath);
+  std::cout << "sandbox intAdd(1, 2) = " << sb.invoke<int(int, int)>("intAdd", 1, 2) << std::endl;
+
+  // 结构体按值传递, 调用者的缓冲区以 out_buffer 传入, 调用完成后复制回来
+  box_t box = sb.invoke<box_t()>("getBox");
+  char buf[256];
+  sb.invoke<void(box_t, char *, unsigned int)>("box2String", box, dll::out_buffer(buf, sizeof(buf)), sizeof(buf));
+  std::cout << "sandbox box2String: " << buf << std::endl;
+
+  point_t p = sb.invoke<point_t()>("getPoint");
+  auto point2Chars = sb.get<format_result_t(const point_t *, char *, size_t)>("point2Chars");
+  format_result_t r = point2Chars(dll::in_buffer(&p, 1), dll::out_buffer(buf, sizeof(buf)), sizeof(buf));
+  std::cout << "sandbox point2Chars: " << buf << " (length " << r.length << ")" << std::endl;
+
+  // 批量调用: 32 个调用只唤醒子进程一次
+  int sums[32];
+  for (int i = 0; i < 32; ++i) sb.post<int(int, int)>(&sums[i], "intAdd", i, i);
+  sb.flush();
+  std::cout << "sandbox batch: intAdd(31, 31) = " << sums[31] << std::endl;
+
+  // 把变量当作函数调用: 子进程崩溃, 宿主收到异常后可以重启子进程
+  try
+  {
+    sb.invoke<void()>("g_version");
+  }
+  catch (const std::exception &e)
+  {
+    std::cerr << e.what() << '\n';
+  }
+  std::cout << "sandbox alive after crash: " << sb.alive() << std::endl;
+  sb.restart();
+  std::cout << "sandbox restarted: intAdd(3, 4) = " << sb.invoke<int(int, int)>("intAdd", 3, 4) << std::endl;
+#else
+  (void)libPath;
+  std::cout << "sandbox not available on this platform" << std::endl;
+#endif
+  std::cout << "---------testSandbox----------" << std::endl;
+}
+
+/// @brief 测试批量解析: 并发加载一组动态库并解析同一组入口符号, 得到 动态库 x 符号 的地址表
+void testPluginScan(const std::string &libPath)
+{
+  std::cout << "---------testPluginScan----------" << std::endl;
+  const std::vector<std::string> entry_points = {"intAdd", "getBox", "notExistFunc"};
+  std::vector<std::string> paths = dll::list_libraries(".");  // 当前目录中的所有动态库
+  paths.push_back("./not_exist_plugin" + std::string(libPath.substr(libPath.rfind('.'))));
+  dll::symbol_matrix table = dll::resolve_all(paths, entry_points);
+  for (std::size_t i = 0; i < table.rows(); ++i)
+  {
+    const dll::load_result &r = table.library(i);
+    if (!r.ok())
+    {
+      std::cout << r.path << ": " << r.error << std::endl;
+      continue;
+    }
+    std::cout << r.path << ": " << table.found(i) << "/" << table.columns() << " symbols";
+    for (std::size_t j = 0; j < table.columns(); ++j) std::cout << ", " << table.symbols()[j] << "=" << table.has(i, j);
+    std::cout << std::endl;
+    if (auto add = table.get<int(int, int)>(i, table.column("intAdd")))
+    {
+      std::cout << "  intAdd(20, 22) = " << add(20, 22) << std::endl;
+    }
+  }
+  std::cout << "---------testPluginScan----------" << std::endl;
+}
@@ -0,0 +1,248 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Common
+{
+// 异步日志: 生产者把日志写入有界无锁 MPSC 队列, 后台线程批量写入一直打开的文件
+//   - 生产者不加锁、不阻塞: 队列满时丢弃该条日志并计数(dropped())
+//   - 按大小和时间刷新: 缓冲超过 flushBytes 或距上次写入超过 flushInterval 时写入文件
+//   - 单条日志超过 kMaxMessage 字节时截断
+//   - 后台线程由构造函数(或 shutdown() 之后的 start())启动, 由 shutdown() 写出剩余日志并 join
+class AsyncLogger
+{
+ public:
+  static constexpr std::size_t kMaxMessage = 240;  // 单条日志最大长度(字节)
+
+  // capacity: 队列槽位数(向上取整为 2 的幂); flushBytes: 缓冲写入阈值; flushInterval: 最长刷新间隔
+  explicit AsyncLogger(std::string filename, std::size_t capacity = 4096, std::size_t flushBytes = 64 * 1024,
+                       std::chrono::milliseconds flushInterval = std::chrono::milliseconds(200)) :
+    filename_(std::move(filename)), flushBytes_(flushBytes), flushInterval_(flushInterval)
+  {
+    std::size_t size = 2;
+    while (size < capacity) size <<= 1;
+    mask_ = size - 1;
+    cells_.reset(new Cell[size]);
+    for (std::size_t i = 0; i < size; ++i) cells_[i].seq.store(i, std::memory_order_relaxed);
+    buffer_.reserve(flushBytes_ * 2);
+    start();
+  }
+
+  ~AsyncLogger()
+  {
+#if defined(_WIN32) || defined(_WIN64)
+    // DLL 卸载时析构函数运行在加载器锁内, 不能 join, 也不能等待后台线程(进程退出时它已被系统终止);
+    // 宿主应在 FreeLibrary 之前调用 shutdown(), 这里只处理没有调用时的线程对象(剩余日志丢失)
+    if (worker_.joinable()) worker_.detach();
+#else
+    shutdown();
+#endif
+  }
+
+  AsyncLogger(const AsyncLogger &) = delete;
+  AsyncLogger &operator=(const AsyncLogger &) = delete;
+
+  // 写入一条日志(无锁, 不阻塞), 队列已满时丢弃并返回 false
+  // 后台线程未运行(shutdown() 之后)时日志留在队列中, 直到 start() 重新启动
+  bool log(const char *data, std::size_t len) noexcept
+  {
+    std::size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+    Cell *cell;
+    for (;;)
+    {
+      cell = &cells_[pos & mask_];
+      const std::size_t seq = cell->seq.load(std::memory_order_acquire);
+      const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+      if (diff == 0)
+      {
+        if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+      }
+      else if (diff < 0)
+      {
+        dropped_.fetch_add(1, std::memory_order_relaxed);  // 队列已满
+        return false;
+      }
+      else
+      {
+        pos = enqueuePos_.load(std::memory_order_relaxed);
+      }
+    }
+    if (len < kMaxMessage)
+    {
+      cell->len = len;
+      std::memcpy(cell->text, data, len);
+    }
+    else
+    {
+      cell->len = kMaxMessage;  // 截断时保留最后一个字节写入换行, 避免下一条日志接在同一行
+      std::memcpy(cell->text, data, kMaxMessage - 1);
+      cell->text[kMaxMessage - 1] = '\n';
+    }
+    cell->seq.store(pos + 1, std::memory_order_release);
+    if (((pos + 1) & (mask_ >> 1)) == 0) cv_.notify_one();  // 每写入半个队列唤醒一次后台线程, 避免队列被写满
+    return true;
+  }
+
+  bool log(const std::string &message) noexcept
+  {
+    return log(message.data(), message.size());
+  }
+
+  // 等待此前写入的日志全部写入文件
+  void flush()
+  {
+    if (!running_.load(std::memory_order_acquire)) return;  // 后台线程未运行: 没有线程写出, 直接返回
+    std::unique_lock<std::mutex> lock(mtx_);
+    const std::uint64_t target = ++flushRequested_;
+    cv_.notify_one();
+    done_.wait(lock, [this, target] { return flushCompleted_ >= target || exited_; });
+  }
+
+  // 启动后台线程, 已在运行时不做任何事
+  // throw std::system_error 创建线程失败
+  void start()
+  {
+    std::lock_guard<std::mutex> guard(lifeMtx_);
+    if (running_.load(std::memory_order_relaxed)) return;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      stop_ = false;
+      exited_ = false;
+    }
+    worker_ = std::thread([this] { run(); });
+    running_.store(true, std::memory_order_release);
+  }
+
+  // 写出剩余日志、关闭文件并等待后台线程结束(join), 之后需调用 start() 才会再写入文件
+  // Windows 上必须在卸载动态库之前调用(不能在加载器锁内等待线程退出)
+  void shutdown()
+  {
+    std::lock_guard<std::mutex> guard(lifeMtx_);
+    if (!running_.load(std::memory_order_relaxed)) return;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      stop_ = true;
+    }
+    cv_.notify_one();
+    worker_.join();
+    drain();  // join 期间写入的日志; 持有 lifeMtx_, 此时没有其他消费者
+    writeOut();
+    if (ofs_.is_open()) ofs_.close();
+    running_.store(false, std::memory_order_release);
+  }
+
+  // 因队列已满而丢弃的日志条数
+  std::uint64_t dropped() const noexcept
+  {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Cell
+  {
+    std::atomic<std::size_t> seq;
+    std::size_t len;
+    char text[kMaxMessage];
+  };
+
+  // 后台线程: 周期性(或被唤醒时)取出队列中的所有日志, 按大小或时间写入文件
+  void run()
+  {
+    auto lastWrite = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mtx_);
+    for (;;)
+    {
+      cv_.wait_for(lock, flushInterval_, [this] { return stop_ || flushRequested_ != flushCompleted_ || halfFull(); });
+      const bool stopping = stop_;
+      const std::uint64_t requested = flushRequested_;
+      lock.unlock();
+
+      drain();
+      const auto now = std::chrono::steady_clock::now();
+      if (stopping || requested != flushCompleted_ || buffer_.size() >= flushBytes_ ||
+          now - lastWrite >= flushInterval_)
+      {
+        writeOut();
+        lastWrite = now;
+      }
+
+      lock.lock();
+      if (flushCompleted_ != requested)
+      {
+        flushCompleted_ = requested;
+        done_.notify_all();
+      }
+      if (stopping) break;
+    }
+    exited_ = true;
+    done_.notify_all();
+  }
+
+  // 队列中的日志是否已超过一半(生产者在这个时候唤醒后台线程)
+  bool halfFull() const noexcept
+  {
+    return enqueuePos_.load(std::memory_order_relaxed) - dequeuePos_ > (mask_ >> 1);
+  }
+
+  // 取出队列中已写入的所有日志追加到缓冲, 缓冲超过阈值时立即写入文件
+  void drain()
+  {
+    for (;;)
+    {
+      Cell &cell = cells_[dequeuePos_ & mask_];
+      if (cell.seq.load(std::memory_order_acquire) != dequeuePos_ + 1) return;  // 队列已空
+      buffer_.append(cell.text, cell.len);
+      cell.seq.store(dequeuePos_ + mask_ + 1, std::memory_order_release);
+      ++dequeuePos_;
+      if (buffer_.size() >= flushBytes_) writeOut();
+    }
+  }
+
+  void writeOut()
+  {
+    if (buffer_.empty()) return;
+    if (!ofs_.is_open())
+    {
+      ofs_.open(filename_, std::ios::out | std::ios::app);  // 首次写入时打开, 之后一直保持打开
+      if (!ofs_.is_open()) return;                          // 打开失败时保留缓冲, 下次再试
+    }
+    ofs_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    ofs_.flush();
+    buffer_.clear();
+  }
+
+  std::string filename_;
+  std::size_t flushBytes_;
+  std::chrono::milliseconds flushInterval_;
+
+  std::unique_ptr<Cell[]> cells_;           // 环形队列槽位
+  std::size_t mask_{0};                     // 槽位数 - 1
+  std::atomic<std::size_t> enqueuePos_{0};  // 生产者写入位置
+  std::size_t dequeuePos_{0};               // 消费者读取位置(只由后台线程访问)
+  std::atomic<std::uint64_t> dropped_{0};   // 队列满时丢弃的条数
+
+  std::string buffer_;  // 待写入文件的内容(只由后台线程访问)
+  std::ofstream ofs_;   // 一直打开的日志文件(只由后台线程访问)
+
+  std::mutex lifeMtx_;                // 串行化后台线程的启动与 shutdown()
+  std::atomic<bool> running_{false};  // 后台线程是否已启动
+  std::mutex mtx_;                    // 只用于后台线程的等待与 flush() 请求, 不在生产者路径上
+  std::condition_variable cv_;
+  std::condition_variable done_;
+  bool stop_{false};
+  bool exited_{false};
+  std::uint64_t flushRequested_{0};
+  std::uint64_t flushCompleted_{0};
+  std::thread worker_;
+};
+
+}  // namespace Common
@@ -0,0 +1,96 @@
+#pragma once
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <system_error>
+
+namespace Common
+{
+// 向调用者提供的固定缓冲写入文本, 不分配内存; 数字使用 std::to_chars 格式化(与区域设置无关)
+//   - 输出与 snprintf 一致: 空间不足时保留能写下的前缀并以 '\0' 结尾, truncated() 为 true
+//   - 浮点数按 "%.Nf" 格式输出(需要 GCC 11 / MSVC 2019 16.4 及以上版本的浮点 std::to_chars)
+class CharWriter
+{
+ public:
+  // buf 可以为 nullptr(此时 size 必须为 0), size 包含末尾 '\0' 的空间
+  CharWriter(char *buf, std::size_t size) noexcept : buf_(buf), size_(size), end_(size > 0 ? size - 1 : 0) {}
+
+  CharWriter &append(const char *data, std::size_t len) noexcept
+  {
+    const std::size_t room = end_ - pos_;
+    if (len > room)
+    {
+      len = room;
+      truncated_ = true;
+    }
+    if (len > 0) std::memcpy(buf_ + pos_, data, len);
+    pos_ += len;
+    return *this;
+  }
+
+  template <std::size_t N>
+  CharWriter &append(const char (&literal)[N]) noexcept
+  {
+    return append(literal, N - 1);
+  }
+
+  CharWriter &append(int value) noexcept
+  {
+    char tmp[16];
+    auto r = std::to_chars(tmp, tmp + sizeof(tmp), value);
+    return append(tmp, static_cast<std::size_t>(r.ptr - tmp));
+  }
+
+  // 按 "%.{precision}f" 格式输出浮点数, precision 不超过 kMaxPrecision
+  CharWriter &append(double value, int precision) noexcept
+  {
+    // 剩余空间足够时直接写入目标缓冲, 否则先写入临时缓冲再截断, 保证截断结果与 snprintf 相同
+    auto r = std::to_chars(buf_ + pos_, buf_ + end_, value, std::chars_format::fixed, precision);
+    if (r.ec == std::errc())
+    {
+      pos_ = static_cast<std::size_t>(r.ptr - buf_);
+      return *this;
+    }
+    char tmp[kMaxFixedLength];
+    r = std::to_chars(tmp, tmp + sizeof(tmp), value, std::chars_format::fixed, precision);
+    const std::size_t len = r.ec == std::errc() ? static_cast<std::size_t>(r.ptr - tmp) : 0;
+    return append(tmp, len < sizeof(tmp) ? len : sizeof(tmp));  // 长度不会超过 tmp, 显式限定以免误报越界警告
+  }
+
+  // 写入末尾 '\0'(缓冲非空时), 返回写入的字符数(不含 '\0')
+  std::size_t finish() noexcept
+  {
+    if (size_ > 0) buf_[pos_] = '\0';
+    return pos_;
+  }
+
+  // 当前位置回退到 pos(用于丢弃写了一半的记录)
+  void rewind(std::size_t pos) noexcept
+  {
+    if (pos < pos_) pos_ = pos;
+  }
+
+  std::size_t size() const noexcept
+  {
+    return pos_;
+  }
+
+  bool truncated() const noexcept
+  {
+    return truncated_;
+  }
+
+  static constexpr int kMaxPrecision = 17;
+
+ private:
+  // "%.17f" 的最长输出: 符号 + 309 位整数 + 小数点 + 17 位小数
+  static constexpr std::size_t kMaxFixedLength = 1 + 309 + 1 + kMaxPrecision;
+
+  char *buf_;
+  std::size_t size_;       // 缓冲大小(含 '\0')
+  std::size_t end_;        // 可写入的字符数(不含 '\0')
+  std::size_t pos_{0};     // 已写入的字符数
+  bool truncated_{false};  // 是否因空间不足截断过
+};
+
+}  // namespace Common
@@ -1,4 +1,7 @@
 #pragma once
+#include <stddef.h>  // size_t
+#include <stdint.h>  // uint32_t/uint64_t
+
 #include "dll_export.h"
 
 /*
@@ -28,12 +31,49 @@ struct box_t
   point_t max;    // 最大点
 };
 
+// SoA(Structure of Arrays) 布局的点集合: x/y/z 分量各自连续存放, 便于 SIMD 处理和跨动态库交换大量数据
+// 数组按 64 字节(缓存行)对齐, 内存必须通过 point_soa_* 函数分配和释放(保证由同一个运行库分配/释放)
+// 调用者可以直接读写 x[i]/y[i]/z[i] (i < capacity) 并修改 size (size <= capacity)
+struct point_soa_t
+{
+  double *x;        // x 分量数组
+  double *y;        // y 分量数组
+  double *z;        // z 分量数组
+  size_t size;      // 有效元素个数
+  size_t capacity;  // 已分配的元素个数
+};
+
+// SoA 布局的 box 集合: 编号与名称单独存放, 只访问坐标时不会把 64 字节的名称带入缓存
+// min/max 的 size 与 capacity 始终与外层一致, 内存通过 box_soa_* 函数分配和释放
+struct box_soa_t
+{
+  int *id;           // box 编号数组
+  char (*name)[64];  // box 名称数组, 每个名称固定 64 字节
+  point_soa_t min;   // 最小点
+  point_soa_t max;   // 最大点
+  size_t size;       // 有效元素个数
+  size_t capacity;   // 已分配的元素个数
+};
+
+// 格式化结果: length 为写入 buf 的字符数(不含末尾 '\0')
+// truncated: 0 表示完整输出; 1 表示空间不足、输出已截断(包括 buf 为空或 size 为 0); -1 表示要格式化的对象为空
+struct format_result_t
+{
+  size_t length;
+  int truncated;
+};
+
 // 函数指针类型定义
 typedef void (*double_callback_t)(double x, double y, double z);  // 简单函数回调
 typedef void (*point_callback_t)(point_t p);                      // 按值传递 point_t
 typedef void (*box_callback_t)(box_t *p);                         // 指针传递 box_t
 
+// 批量回调: 一次回调传递一组事件, 数组只在回调期间有效
+typedef void (*point_batch_callback_t)(const point_t *points, unsigned int count);  // point_t 数组
+typedef void (*box_batch_callback_t)(const box_t *boxes, unsigned int count);       // box_t 数组
+
 // 版本号字符串，导出为只读全局变量
+#define DYNAMIC_VERSION "v1.2.3"
 DLL_PUBLIC_API extern const char *g_version;
 
 // 导出全局变量
@@ -55,6 +95,37 @@ DLL_PUBLIC_API double doubleAdd(double a, double b);
 DLL_PUBLIC_API point_t getPoint();
 DLL_PUBLIC_API void printPoint(point_t arg);
 
+// 批量(数组)版本: 一次调用处理 n 个元素, out[i] = a[i] + b[i]; out 可以与 a 或 b 相同(原地计算)
+// 运行时按 CPU 选择 SIMD 实现(x86: AVX2/SSE2, aarch64: NEON), 结果与逐个调用标量版本一致
+DLL_PUBLIC_API void intAddN(const int *a, const int *b, int *out, size_t n);
+DLL_PUBLIC_API void floatAddN(const float *a, const float *b, float *out, size_t n);
+DLL_PUBLIC_API void doubleAddN(const double *a, const double *b, double *out, size_t n);
+// 批量变换 n 个点: out[i] = in[i] * scale + offset(逐分量); out 可以与 in 相同
+DLL_PUBLIC_API void transformPoints(const point_t *in, point_t *out, size_t n, double scale, point_t offset);
+// 当前使用的 SIMD 实现名称: "avx2"、"sse2"、"neon" 或 "scalar"
+DLL_PUBLIC_API const char *simdLevel();
+
+// SoA 点集合: init 初始化 soa 并分配 capacity 个元素(size 为 0), reserve 扩容并保留已有数据
+// 成功返回 0, 内存分配失败返回 -1(soa 保持不变); free 释放内存并把 soa 清零, 可以重复调用
+DLL_PUBLIC_API int point_soa_init(point_soa_t *soa, size_t capacity);
+DLL_PUBLIC_API int point_soa_reserve(point_soa_t *soa, size_t capacity);
+DLL_PUBLIC_API void point_soa_free(point_soa_t *soa);
+// AoS 与 SoA 互相转换, 最多转换 n 与容量中较小的个数, 返回实际转换的元素个数; from_aos 同时设置 size
+DLL_PUBLIC_API size_t point_soa_from_aos(point_soa_t *dst, const point_t *src, size_t n);
+DLL_PUBLIC_API size_t point_soa_to_aos(const point_soa_t *src, point_t *dst, size_t n);
+// SoA 版本的 transformPoints: out = in * scale + offset, out->size 设为 in->size 与 out->capacity 中较小者
+// out 可以与 in 相同(原地计算)
+DLL_PUBLIC_API void transformPointsSoa(const point_soa_t *in, point_soa_t *out, double scale, point_t offset);
+// 计算点集合的包围盒, 写入 min/max; 集合为空时返回 -1, 否则返回 0
+DLL_PUBLIC_API int boundsPointsSoa(const point_soa_t *soa, point_t *min, point_t *max);
+
+// SoA box 集合, 用法与 point_soa_* 相同
+DLL_PUBLIC_API int box_soa_init(box_soa_t *soa, size_t capacity);
+DLL_PUBLIC_API int box_soa_reserve(box_soa_t *soa, size_t capacity);
+DLL_PUBLIC_API void box_soa_free(box_soa_t *soa);
+DLL_PUBLIC_API size_t box_soa_from_aos(box_soa_t *dst, const box_t *src, size_t n);
+DLL_PUBLIC_API size_t box_soa_to_aos(const box_soa_t *src, box_t *dst, size_t n);
+
 // 返回常量的Hello字符串
 DLL_PUBLIC_API const char *getHelloString();
 // 按值返回box_t对象
@@ -65,6 +136,15 @@ DLL_PUBLIC_API box_t getBox();
 DLL_PUBLIC_API void box2String(box_t arg, char *buf, unsigned int max_size);
 DLL_PUBLIC_API void point2String(point_t *arg, char *buf, unsigned int max_size);  // 参数arg为指针
 
+// 快速格式化(不分配内存, 与区域设置无关), 输出内容与 box2String / point2String 完全相同
+// 空间不足时与 snprintf 一样写入能写下的前缀, 并通过返回值报告长度和截断; size 包含末尾 '\0'
+DLL_PUBLIC_API format_result_t box2Chars(const box_t *arg, char *buf, size_t size);
+DLL_PUBLIC_API format_result_t point2Chars(const point_t *arg, char *buf, size_t size);
+// 批量格式化 n 个点到同一个缓冲, 每个点一行(与 point2String 相同的格式加 '\n')
+// 只写入完整的行: 空间不足时停在最后一个完整的点, *formatted(可为空)为已格式化的点数, 可从该位置继续
+DLL_PUBLIC_API format_result_t points2Chars(const point_t *points, size_t n, char *buf, size_t size,
+                                            size_t *formatted);
+
 // 1. 注册回调函数
 DLL_PUBLIC_API void register_double_callback(double_callback_t cb);  // 函数 1
 DLL_PUBLIC_API void register_point_callback(point_callback_t cb);    // 函数 2
@@ -76,6 +156,102 @@ DLL_PUBLIC_API void register_box_callback(box_callback_t cb);        // 函数 4
 // n = 4 表示调用 box_callback
 DLL_PUBLIC_API void trigger_callbacks(int n);
 
+// 3. 批量回调: 注册接收事件数组的回调函数
+DLL_PUBLIC_API void register_point_batch_callback(point_batch_callback_t cb);
+DLL_PUBLIC_API void register_box_batch_callback(box_batch_callback_t cb);
+
+// 4. 批量触发 count 个事件, 事件按批(每批最多 256 个)传给已注册的批量回调
+// n = 2 表示触发 point 批量回调
+// n = 4 表示触发 box 批量回调
+DLL_PUBLIC_API void trigger_callbacks_batch(int n, unsigned int count);
+
+// 5. 写出剩余的回调日志并结束日志后台线程(之后的回调日志不再写入文件)
+// Windows 上卸载动态库(FreeLibrary)之前必须调用: DLL 卸载时不能在加载器锁内等待线程退出
+DLL_PUBLIC_API void shutdown_log();
+
+// ================= 插件描述符 =================
+// 宿主只需查找一个入口 get_plugin_descriptor(), 之后通过描述符中的函数指针调用, 不再按名称查找符号;
+// 加载时先校验 ABI 版本和结构体大小/对齐, 在布局不一致导致内存被悄悄破坏之前报错
+// 兼容规则: 新版本只在 dynamic_plugin_t 末尾追加成员并增大 descriptor_size; 删除或改变已有成员时增加 ABI 版本号
+#define DYNAMIC_PLUGIN_ABI_VERSION 1
+
+// 功能位(plugin_abi_t::features)
+#define DYNAMIC_PLUGIN_FEATURE_CALLBACKS 0x01u        // 单个事件回调
+#define DYNAMIC_PLUGIN_FEATURE_BATCH_CALLBACKS 0x02u  // 批量回调
+#define DYNAMIC_PLUGIN_FEATURE_SIMD 0x04u             // 批量(SIMD)算术与变换
+#define DYNAMIC_PLUGIN_FEATURE_SOA 0x08u              // SoA 容器
+#define DYNAMIC_PLUGIN_FEATURE_FAST_FORMAT 0x10u      // 不分配内存的格式化
+
+// 参与 ABI 的结构体布局
+struct plugin_layout_t
+{
+  const char *name;  // 结构体名称
+  uint32_t size;     // sizeof
+  uint32_t align;    // alignof
+};
+
+// 描述符公共头部, 与宿主端 dll::plugin_abi 的布局相同
+struct plugin_abi_t
+{
+  uint32_t abi_version;            // DYNAMIC_PLUGIN_ABI_VERSION
+  uint32_t descriptor_size;        // sizeof(dynamic_plugin_t)
+  uint64_t features;               // DYNAMIC_PLUGIN_FEATURE_* 按位或
+  uint32_t layout_count;           // layouts 数组长度
+  const plugin_layout_t *layouts;  // point_t、box_t 等结构体的布局
+};
+
+// 静态初始化的描述符: 公共头部 + 版本号 + 所有导出函数
+struct dynamic_plugin_t
+{
+  plugin_abi_t abi;
+  const char *version;
+
+  void (*sayHello)();
+  int (*intAdd)(int a, int b);
+  float (*floatAdd)(float a, float b);
+  double (*doubleAdd)(double a, double b);
+  point_t (*getPoint)();
+  void (*printPoint)(point_t arg);
+  const char *(*getHelloString)();
+  box_t (*getBox)();
+  void (*box2String)(box_t arg, char *buf, unsigned int max_size);
+  void (*point2String)(point_t *arg, char *buf, unsigned int max_size);
+
+  void (*register_double_callback)(double_callback_t cb);
+  void (*register_point_callback)(point_callback_t cb);
+  void (*register_box_callback)(box_callback_t cb);
+  void (*trigger_callbacks)(int n);
+  void (*register_point_batch_callback)(point_batch_callback_t cb);
+  void (*register_box_batch_callback)(box_batch_callback_t cb);
+  void (*trigger_callbacks_batch)(int n, unsigned int count);
+
+  void (*intAddN)(const int *a, const int *b, int *out, size_t n);
+  void (*floatAddN)(const float *a, const float *b, float *out, size_t n);
+  void (*doubleAddN)(const double *a, const double *b, double *out, size_t n);
+  void (*transformPoints)(const point_t *in, point_t *out, size_t n, double scale, point_t offset);
+  const char *(*simdLevel)();
+
+  int (*point_soa_init)(point_soa_t *soa, size_t capacity);
+  int (*point_soa_reserve)(point_soa_t *soa, size_t capacity);
+  void (*point_soa_free)(point_soa_t *soa);
+  size_t (*point_soa_from_aos)(point_soa_t *dst, const point_t *src, size_t n);
+  size_t (*point_soa_to_aos)(const point_soa_t *src, point_t *dst, size_t n);
+  void (*transformPointsSoa)(const point_soa_t *in, point_soa_t *out, double scale, point_t offset);
+  int (*boundsPointsSoa)(const point_soa_t *soa, point_t *min, point_t *max);
+  int (*box_soa_init)(box_soa_t *soa, size_t capacity);
+  int (*box_soa_reserve)(box_soa_t *soa, size_t capacity);
+  void (*box_soa_free)(box_soa_t *soa);
+  size_t (*box_soa_from_aos)(box_soa_t *dst, const box_t *src, size_t n);
+  size_t (*box_soa_to_aos)(const box_soa_t *src, box_t *dst, size_t n);
+
+  format_result_t (*box2Chars)(const box_t *arg, char *buf, size_t size);
+  format_result_t (*point2Chars)(const point_t *arg, char *buf, size_t size);
+  format_result_t (*points2Chars)(const point_t *points, size_t n, char *buf, size_t size, size_t *formatted);
+};
+
+// 返回指向静态描述符的指针(整个进程生命周期内不变)
+DLL_PUBLIC_API const dynamic_plugin_t *get_plugin_descriptor();
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
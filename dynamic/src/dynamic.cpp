@@ -2,11 +2,13 @@
 
 #include <cstdio>   // snprintf
 #include <cstring>  // memset
+#include <dynamic/async_logger.hpp>
+#include <dynamic/char_writer.hpp>
 #include <dynamic/common.hpp>
 #include <string>
 
 // 版本号字符串，导出为只读全局变量
-DLL_PUBLIC_API const char *g_version = "v1.2.3";
+DLL_PUBLIC_API const char *g_version = DYNAMIC_VERSION;
 
 // 全局变量定义
 DLL_PUBLIC_API int g_counter = 42;
@@ -43,9 +45,12 @@ DLL_PUBLIC_API point_t getPoint()
 
 DLL_PUBLIC_API void printPoint(point_t arg)
 {
-  std::string str =
-    "{x: " + std::to_string(arg.x) + " y: " + std::to_string(arg.y) + " z: " + std::to_string(arg.z) + "}";
-  Common::print(str);
+  // 与 std::to_string 相同的 "%f" 格式, 在栈上格式化, 不分配内存(3 个最长的 "%f" 输出也不超过 1024 字节)
+  char buf[1024];
+  Common::CharWriter w(buf, sizeof(buf));
+  w.append("{x: ").append(arg.x, 6).append(" y: ").append(arg.y, 6).append(" z: ").append(arg.z, 6).append("}");
+  w.finish();
+  Common::print(buf);
 }
 
 // 返回常量的Hello字符串
@@ -70,20 +75,31 @@ DLL_PUBLIC_API box_t getBox()
   return b;
 }
 
+// 格式化 box_t, 与 "box_t { id=%d, name='%s', min=(%.3f,%.3f,%.3f), max=(%.3f,%.3f,%.3f) }" 相同
+static void writeBox(Common::CharWriter &w, const box_t &arg)
+{
+  w.append("box_t { id=").append(arg.id).append(", name='").append(arg.name, strnlen(arg.name, sizeof(arg.name)));
+  w.append("', min=(").append(arg.min.x, 3).append(",").append(arg.min.y, 3).append(",").append(arg.min.z, 3);
+  w.append("), max=(").append(arg.max.x, 3).append(",").append(arg.max.y, 3).append(",").append(arg.max.z, 3);
+  w.append(") }");
+}
+
+// 格式化 point_t, 与 "point_t { x=%.3f, y=%.3f, z=%.3f }" 相同
+static void writePoint(Common::CharWriter &w, const point_t &arg)
+{
+  w.append("point_t { x=").append(arg.x, 3).append(", y=").append(arg.y, 3).append(", z=").append(arg.z, 3);
+  w.append(" }");
+}
+
 // 将 box_t 转成字符串形式，写入 buf，长度不超过 max_size（包含末尾 \0）
 DLL_PUBLIC_API void box2String(box_t arg, char *buf, unsigned int max_size)
 {
   if (!buf || max_size == 0) return;
 
   // 格式化示例字符串：
-  // "box_t { id=42, name='Box Object id = 42', min=(123.000000,1234.000000,12345.000000),
-  // max=(777.000000,888.000000,999.000000) }"
-  int ret = snprintf(buf, max_size, "box_t { id=%d, name='%s', min=(%.3f,%.3f,%.3f), max=(%.3f,%.3f,%.3f) }", arg.id,
-                     arg.name, arg.min.x, arg.min.y, arg.min.z, arg.max.x, arg.max.y, arg.max.z);
-
-  // snprintf 会自动保证以 '\0' 结尾，若字符串超长，则会截断输出
-  // ret 返回写入的字符数（不包含 '\0'），可以根据需要检查是否超出 max_size
-  (void)ret;  // 如果不需要额外处理，可以忽略
+  // "box_t { id=42, name='Box Object id = 42', min=(123.000,1234.000,12345.000), max=(777.000,888.000,999.000) }"
+  // 若字符串超长，则会截断输出(与 snprintf 相同, 保证以 '\0' 结尾)
+  box2Chars(&arg, buf, max_size);
 }
 
 // 将 point_t 指针指向的数据转成字符串，写入 buf，长度不超过 max_size（包含末尾 \0）
@@ -92,16 +108,70 @@ DLL_PUBLIC_API void point2String(point_t *arg, char *buf, unsigned int max_size)
   if (!buf || max_size == 0 || !arg) return;
 
   // 格式化示例字符串：
-  // "point_t { x=123.000000, y=456.000000, z=789.000000 }"
-  int ret = snprintf(buf, max_size, "point_t { x=%.3f, y=%.3f, z=%.3f }", arg->x, arg->y, arg->z);
+  // "point_t { x=123.000, y=456.000, z=789.000 }"
+  point2Chars(arg, buf, max_size);
+}
 
-  (void)ret;
+// 参数无效(要格式化的对象为空): 缓冲可用时写入空字符串, truncated 为 -1
+static format_result_t invalidFormat(char *buf, size_t size)
+{
+  if (buf && size > 0) buf[0] = '\0';
+  return {0, -1};
+}
+
+// 没有缓冲(buf 为空或 size 为 0)时按空间不足处理: 输出为空, truncated 为 1
+DLL_PUBLIC_API format_result_t box2Chars(const box_t *arg, char *buf, size_t size)
+{
+  if (!arg) return invalidFormat(buf, size);
+  Common::CharWriter w(buf, buf ? size : 0);
+  writeBox(w, *arg);
+  return {w.finish(), w.truncated()};
+}
+
+DLL_PUBLIC_API format_result_t point2Chars(const point_t *arg, char *buf, size_t size)
+{
+  if (!arg) return invalidFormat(buf, size);
+  Common::CharWriter w(buf, buf ? size : 0);
+  writePoint(w, *arg);
+  return {w.finish(), w.truncated()};
+}
+
+DLL_PUBLIC_API format_result_t points2Chars(const point_t *points, size_t n, char *buf, size_t size,
+                                            size_t *formatted)
+{
+  if (formatted) *formatted = 0;
+  if (!points && n > 0) return invalidFormat(buf, size);
+  size_t done = 0;
+  Common::CharWriter w(buf, buf ? size : 0);
+  for (; done < n; ++done)
+  {
+    const size_t line = w.size();
+    writePoint(w, points[done]);
+    w.append("\n");
+    if (w.truncated())
+    {
+      w.rewind(line);  // 丢弃写了一半的行
+      break;
+    }
+  }
+  if (formatted) *formatted = done;
+  return {w.finish(), done < n};
 }
 
 // 静态全局变量存储回调函数指针，初始为 nullptr
 static double_callback_t g_double_cb = nullptr;
 static point_callback_t g_point_cb = nullptr;
 static box_callback_t g_box_cb = nullptr;
+static point_batch_callback_t g_point_batch_cb = nullptr;
+static box_batch_callback_t g_box_batch_cb = nullptr;
+
+// 回调日志: 无锁写入队列, 由后台线程批量写入一直打开的文件(动态库加载时启动后台线程, shutdown_log() 结束)
+static Common::AsyncLogger g_log("dynamic_log.txt");
+
+DLL_PUBLIC_API void shutdown_log()
+{
+  g_log.shutdown();
+}
 
 // 1. 注册回调函数
 DLL_PUBLIC_API void register_double_callback(double_callback_t cb)
@@ -125,7 +195,7 @@ DLL_PUBLIC_API void register_box_callback(box_callback_t cb)
 //   bit 2（值为 4）：触发 box 回调（g_box_cb）
 DLL_PUBLIC_API void trigger_callbacks(int n)
 {
-  Common::writeStringToFile("dynamic_log.txt", "Triggering callbacks, parameter: " + std::to_string(n) + "\n");
+  g_log.log("Triggering callbacks, parameter: " + std::to_string(n) + "\n");
 
   if ((n & 1) && g_double_cb)
   {
@@ -144,3 +214,56 @@ DLL_PUBLIC_API void trigger_callbacks(int n)
     g_box_cb(&box_example);
   }
 }
+
+// 3. 注册批量回调函数
+DLL_PUBLIC_API void register_point_batch_callback(point_batch_callback_t cb)
+{
+  g_point_batch_cb = cb;
+}
+DLL_PUBLIC_API void register_box_batch_callback(box_batch_callback_t cb)
+{
+  g_box_batch_cb = cb;
+}
+
+// 4. 批量触发回调: 事件先填入本线程的缓冲数组, 每满一批(或最后不足一批)调用一次批量回调
+// n 的位标志与 trigger_callbacks 相同(bit 1: point, bit 2: box), 每个事件的数据由其序号生成
+DLL_PUBLIC_API void trigger_callbacks_batch(int n, unsigned int count)
+{
+  static const unsigned int kBatchSize = 256;
+  g_log.log("Triggering batch callbacks, parameter: " + std::to_string(n) + ", count: " + std::to_string(count) +
+              "\n");
+
+  if ((n & 2) && g_point_batch_cb)
+  {
+    thread_local point_t points[kBatchSize];
+    for (unsigned int begin = 0; begin < count; begin += kBatchSize)
+    {
+      const unsigned int size = count - begin < kBatchSize ? count - begin : kBatchSize;
+      for (unsigned int i = 0; i < size; ++i)
+      {
+        const double k = begin + i;
+        points[i] = {10.0 + k, 20.0 + k, 30.0 + k};
+      }
+      g_point_batch_cb(points, size);
+    }
+  }
+
+  if ((n & 4) && g_box_batch_cb)
+  {
+    thread_local box_t boxes[kBatchSize];
+    for (unsigned int begin = 0; begin < count; begin += kBatchSize)
+    {
+      const unsigned int size = count - begin < kBatchSize ? count - begin : kBatchSize;
+      for (unsigned int i = 0; i < size; ++i)
+      {
+        box_t &b = boxes[i];
+        const double k = begin + i;
+        b.id = static_cast<int>(100 + begin + i);
+        snprintf(b.name, sizeof(b.name), "Batch Box %u", begin + i);
+        b.min = {0.1 + k, 0.2 + k, 0.3 + k};
+        b.max = {9.9 + k, 8.8 + k, 7.7 + k};
+      }
+      g_box_batch_cb(boxes, size);
+    }
+  }
+}
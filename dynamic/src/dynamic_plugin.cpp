@@ -0,0 +1,73 @@
+// 插件描述符: 一个静态常量表, 包含 ABI 版本、功能位、结构体布局以及所有导出函数的指针
+// 表中只有常量和函数地址, 由编译器静态初始化, get_plugin_descriptor() 不执行任何初始化代码
+#include <dynamic/dynamic.h>
+
+namespace
+{
+#define DYNAMIC_PLUGIN_LAYOUT(T) {#T, sizeof(T), alignof(T)}
+
+constexpr plugin_layout_t kLayouts[] = {
+    DYNAMIC_PLUGIN_LAYOUT(point_t),   DYNAMIC_PLUGIN_LAYOUT(box_t),           DYNAMIC_PLUGIN_LAYOUT(point_soa_t),
+    DYNAMIC_PLUGIN_LAYOUT(box_soa_t), DYNAMIC_PLUGIN_LAYOUT(format_result_t),
+};
+
+#undef DYNAMIC_PLUGIN_LAYOUT
+
+constexpr uint64_t kFeatures = DYNAMIC_PLUGIN_FEATURE_CALLBACKS | DYNAMIC_PLUGIN_FEATURE_BATCH_CALLBACKS |
+                               DYNAMIC_PLUGIN_FEATURE_SIMD | DYNAMIC_PLUGIN_FEATURE_SOA |
+                               DYNAMIC_PLUGIN_FEATURE_FAST_FORMAT;
+
+// 成员顺序与 dynamic_plugin_t 的声明一一对应
+const dynamic_plugin_t kDescriptor = {
+    {DYNAMIC_PLUGIN_ABI_VERSION, sizeof(dynamic_plugin_t), kFeatures, sizeof(kLayouts) / sizeof(kLayouts[0]),
+     kLayouts},
+    DYNAMIC_VERSION,
+
+    sayHello,
+    intAdd,
+    floatAdd,
+    doubleAdd,
+    getPoint,
+    printPoint,
+    getHelloString,
+    getBox,
+    box2String,
+    point2String,
+
+    register_double_callback,
+    register_point_callback,
+    register_box_callback,
+    trigger_callbacks,
+    register_point_batch_callback,
+    register_box_batch_callback,
+    trigger_callbacks_batch,
+
+    intAddN,
+    floatAddN,
+    doubleAddN,
+    transformPoints,
+    simdLevel,
+
+    point_soa_init,
+    point_soa_reserve,
+    point_soa_free,
+    point_soa_from_aos,
+    point_soa_to_aos,
+    transformPointsSoa,
+    boundsPointsSoa,
+    box_soa_init,
+    box_soa_reserve,
+    box_soa_free,
+    box_soa_from_aos,
+    box_soa_to_aos,
+
+    box2Chars,
+    point2Chars,
+    points2Chars,
+};
+}  // namespace
+
+DLL_PUBLIC_API const dynamic_plugin_t *get_plugin_descriptor()
+{
+  return &kDescriptor;
+}
@@ -0,0 +1,339 @@
+// 批量(数组)版本的算术与 point_t 变换接口, 一次跨越动态库边界处理整段数据
+// 运行时按 CPU 能力选择内核: x86 上 AVX2 > SSE2 > 标量, aarch64 上 NEON, 其他平台标量
+#include <dynamic/dynamic.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define DYNAMIC_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define DYNAMIC_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+// GCC/Clang 需要为单个函数开启指令集(其余代码仍按基线编译), MSVC 可以直接使用内建函数
+#if defined(DYNAMIC_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define DYNAMIC_TARGET_AVX2 __attribute__((target("avx2")))
+#define DYNAMIC_TARGET_SSE2 __attribute__((target("sse2")))
+#else
+#define DYNAMIC_TARGET_AVX2
+#define DYNAMIC_TARGET_SSE2
+#endif
+
+namespace
+{
+// 一组内核函数, 加载后按 CPU 能力选择一次
+struct Kernels
+{
+  void (*intAddN)(const int *, const int *, int *, size_t);
+  void (*floatAddN)(const float *, const float *, float *, size_t);
+  void (*doubleAddN)(const double *, const double *, double *, size_t);
+  void (*transformPoints)(const point_t *, point_t *, size_t, double, point_t);
+  void (*scaleAddN)(const double *, double *, size_t, double, double);  // SoA 单个分量: out = in * scale + offset
+  const char *name;
+};
+
+// ---------------- 标量实现(也用于处理 SIMD 剩余的尾部元素) ----------------
+template <typename T>
+void addScalar(const T *a, const T *b, T *out, size_t begin, size_t n)
+{
+  for (size_t i = begin; i < n; ++i) out[i] = a[i] + b[i];
+}
+
+void transformScalar(const point_t *in, point_t *out, size_t begin, size_t n, double scale, point_t offset)
+{
+  for (size_t i = begin; i < n; ++i)
+  {
+    out[i].x = in[i].x * scale + offset.x;
+    out[i].y = in[i].y * scale + offset.y;
+    out[i].z = in[i].z * scale + offset.z;
+  }
+}
+
+void scaleAddScalar(const double *in, double *out, size_t begin, size_t n, double scale, double offset)
+{
+  for (size_t i = begin; i < n; ++i) out[i] = in[i] * scale + offset;
+}
+
+void intAddScalar(const int *a, const int *b, int *out, size_t n)
+{
+  addScalar(a, b, out, 0, n);
+}
+void floatAddScalar(const float *a, const float *b, float *out, size_t n)
+{
+  addScalar(a, b, out, 0, n);
+}
+void doubleAddScalar(const double *a, const double *b, double *out, size_t n)
+{
+  addScalar(a, b, out, 0, n);
+}
+void transformPointsScalar(const point_t *in, point_t *out, size_t n, double scale, point_t offset)
+{
+  transformScalar(in, out, 0, n, scale, offset);
+}
+void scaleAddNScalar(const double *in, double *out, size_t n, double scale, double offset)
+{
+  scaleAddScalar(in, out, 0, n, scale, offset);
+}
+
+#if defined(DYNAMIC_SIMD_X86)
+// ---------------- SSE2 ----------------
+DYNAMIC_TARGET_SSE2 void intAddSse2(const int *a, const int *b, int *out, size_t n)
+{
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+    __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_add_epi32(va, vb));
+  }
+  addScalar(a, b, out, i, n);
+}
+DYNAMIC_TARGET_SSE2 void floatAddSse2(const float *a, const float *b, float *out, size_t n)
+{
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+  addScalar(a, b, out, i, n);
+}
+DYNAMIC_TARGET_SSE2 void doubleAddSse2(const double *a, const double *b, double *out, size_t n)
+{
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) _mm_storeu_pd(out + i, _mm_add_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+  addScalar(a, b, out, i, n);
+}
+// point_t 是 3 个 double, 每 2 个点(6 个 double)正好是 3 个 128 位向量, 偏移量按 (x,y) (z,x) (y,z) 排列
+DYNAMIC_TARGET_SSE2 void transformPointsSse2(const point_t *in, point_t *out, size_t n, double scale, point_t offset)
+{
+  const __m128d s = _mm_set1_pd(scale);
+  const __m128d o0 = _mm_setr_pd(offset.x, offset.y);
+  const __m128d o1 = _mm_setr_pd(offset.z, offset.x);
+  const __m128d o2 = _mm_setr_pd(offset.y, offset.z);
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2)
+  {
+    const double *src = &in[i].x;
+    double *dst = &out[i].x;
+    __m128d v0 = _mm_loadu_pd(src);
+    __m128d v1 = _mm_loadu_pd(src + 2);
+    __m128d v2 = _mm_loadu_pd(src + 4);
+    _mm_storeu_pd(dst, _mm_add_pd(_mm_mul_pd(v0, s), o0));
+    _mm_storeu_pd(dst + 2, _mm_add_pd(_mm_mul_pd(v1, s), o1));
+    _mm_storeu_pd(dst + 4, _mm_add_pd(_mm_mul_pd(v2, s), o2));
+  }
+  transformScalar(in, out, i, n, scale, offset);
+}
+DYNAMIC_TARGET_SSE2 void scaleAddNSse2(const double *in, double *out, size_t n, double scale, double offset)
+{
+  const __m128d s = _mm_set1_pd(scale);
+  const __m128d o = _mm_set1_pd(offset);
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) _mm_storeu_pd(out + i, _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(in + i), s), o));
+  scaleAddScalar(in, out, i, n, scale, offset);
+}
+
+// ---------------- AVX2 ----------------
+DYNAMIC_TARGET_AVX2 void intAddAvx2(const int *a, const int *b, int *out, size_t n)
+{
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+  {
+    __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+    __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_add_epi32(va, vb));
+  }
+  addScalar(a, b, out, i, n);
+}
+DYNAMIC_TARGET_AVX2 void floatAddAvx2(const float *a, const float *b, float *out, size_t n)
+{
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+  {
+    _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+  }
+  addScalar(a, b, out, i, n);
+}
+DYNAMIC_TARGET_AVX2 void doubleAddAvx2(const double *a, const double *b, double *out, size_t n)
+{
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+  }
+  addScalar(a, b, out, i, n);
+}
+// 每 4 个点(12 个 double)是 3 个 256 位向量, 偏移量按 (x,y,z,x) (y,z,x,y) (z,x,y,z) 排列
+// 使用乘法加加法而不是 FMA, 保证结果与标量实现逐位一致
+DYNAMIC_TARGET_AVX2 void transformPointsAvx2(const point_t *in, point_t *out, size_t n, double scale, point_t offset)
+{
+  const __m256d s = _mm256_set1_pd(scale);
+  const __m256d o0 = _mm256_setr_pd(offset.x, offset.y, offset.z, offset.x);
+  const __m256d o1 = _mm256_setr_pd(offset.y, offset.z, offset.x, offset.y);
+  const __m256d o2 = _mm256_setr_pd(offset.z, offset.x, offset.y, offset.z);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    const double *src = &in[i].x;
+    double *dst = &out[i].x;
+    __m256d v0 = _mm256_loadu_pd(src);
+    __m256d v1 = _mm256_loadu_pd(src + 4);
+    __m256d v2 = _mm256_loadu_pd(src + 8);
+    _mm256_storeu_pd(dst, _mm256_add_pd(_mm256_mul_pd(v0, s), o0));
+    _mm256_storeu_pd(dst + 4, _mm256_add_pd(_mm256_mul_pd(v1, s), o1));
+    _mm256_storeu_pd(dst + 8, _mm256_add_pd(_mm256_mul_pd(v2, s), o2));
+  }
+  transformScalar(in, out, i, n, scale, offset);
+}
+// SoA 布局不需要重排偏移量, 每个分量数组独立计算
+DYNAMIC_TARGET_AVX2 void scaleAddNAvx2(const double *in, double *out, size_t n, double scale, double offset)
+{
+  const __m256d s = _mm256_set1_pd(scale);
+  const __m256d o = _mm256_set1_pd(offset);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_mul_pd(_mm256_loadu_pd(in + i), s), o));
+  }
+  scaleAddScalar(in, out, i, n, scale, offset);
+}
+
+// 检测 CPU 与操作系统是否支持 AVX2(操作系统需保存 YMM 寄存器状态)
+bool cpuHasAvx2()
+{
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) return false;
+  __cpuid(info, 1);
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  const bool avx = (info[2] & (1 << 28)) != 0;
+  if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  return false;
+#endif
+}
+
+// SSE2 是 x86-64 的基线指令集, 只有 32 位 x86 需要检测
+bool cpuHasSse2()
+{
+#if defined(__x86_64__) || defined(_M_X64)
+  return true;
+#elif defined(__GNUC__) || defined(__clang__)
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("sse2");
+#elif defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 1);
+  return (info[3] & (1 << 26)) != 0;
+#else
+  return false;
+#endif
+}
+#endif  // DYNAMIC_SIMD_X86
+
+#if defined(DYNAMIC_SIMD_NEON)
+// ---------------- NEON(aarch64 基线指令集, 无需运行时检测) ----------------
+void intAddNeon(const int *a, const int *b, int *out, size_t n)
+{
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) vst1q_s32(out + i, vaddq_s32(vld1q_s32(a + i), vld1q_s32(b + i)));
+  addScalar(a, b, out, i, n);
+}
+void floatAddNeon(const float *a, const float *b, float *out, size_t n)
+{
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) vst1q_f32(out + i, vaddq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+  addScalar(a, b, out, i, n);
+}
+void doubleAddNeon(const double *a, const double *b, double *out, size_t n)
+{
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) vst1q_f64(out + i, vaddq_f64(vld1q_f64(a + i), vld1q_f64(b + i)));
+  addScalar(a, b, out, i, n);
+}
+void transformPointsNeon(const point_t *in, point_t *out, size_t n, double scale, point_t offset)
+{
+  const float64x2_t s = vdupq_n_f64(scale);
+  const double p0[2] = {offset.x, offset.y}, p1[2] = {offset.z, offset.x}, p2[2] = {offset.y, offset.z};
+  const float64x2_t o0 = vld1q_f64(p0), o1 = vld1q_f64(p1), o2 = vld1q_f64(p2);
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2)
+  {
+    const double *src = &in[i].x;
+    double *dst = &out[i].x;
+    vst1q_f64(dst, vaddq_f64(vmulq_f64(vld1q_f64(src), s), o0));
+    vst1q_f64(dst + 2, vaddq_f64(vmulq_f64(vld1q_f64(src + 2), s), o1));
+    vst1q_f64(dst + 4, vaddq_f64(vmulq_f64(vld1q_f64(src + 4), s), o2));
+  }
+  transformScalar(in, out, i, n, scale, offset);
+}
+void scaleAddNNeon(const double *in, double *out, size_t n, double scale, double offset)
+{
+  const float64x2_t s = vdupq_n_f64(scale);
+  const float64x2_t o = vdupq_n_f64(offset);
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) vst1q_f64(out + i, vaddq_f64(vmulq_f64(vld1q_f64(in + i), s), o));
+  scaleAddScalar(in, out, i, n, scale, offset);
+}
+#endif  // DYNAMIC_SIMD_NEON
+
+Kernels selectKernels()
+{
+#if defined(DYNAMIC_SIMD_X86)
+  if (cpuHasAvx2()) return {intAddAvx2, floatAddAvx2, doubleAddAvx2, transformPointsAvx2, scaleAddNAvx2, "avx2"};
+  if (cpuHasSse2()) return {intAddSse2, floatAddSse2, doubleAddSse2, transformPointsSse2, scaleAddNSse2, "sse2"};
+#elif defined(DYNAMIC_SIMD_NEON)
+  return {intAddNeon, floatAddNeon, doubleAddNeon, transformPointsNeon, scaleAddNNeon, "neon"};
+#endif
+  return {intAddScalar, floatAddScalar, doubleAddScalar, transformPointsScalar, scaleAddNScalar, "scalar"};
+}
+
+// 首次调用时检测一次 CPU(线程安全的局部静态变量初始化)
+const Kernels &kernels()
+{
+  static const Kernels k = selectKernels();
+  return k;
+}
+}  // namespace
+
+DLL_PUBLIC_API void intAddN(const int *a, const int *b, int *out, size_t n)
+{
+  kernels().intAddN(a, b, out, n);
+}
+
+DLL_PUBLIC_API void floatAddN(const float *a, const float *b, float *out, size_t n)
+{
+  kernels().floatAddN(a, b, out, n);
+}
+
+DLL_PUBLIC_API void doubleAddN(const double *a, const double *b, double *out, size_t n)
+{
+  kernels().doubleAddN(a, b, out, n);
+}
+
+DLL_PUBLIC_API void transformPoints(const point_t *in, point_t *out, size_t n, double scale, point_t offset)
+{
+  kernels().transformPoints(in, out, n, scale, offset);
+}
+
+DLL_PUBLIC_API void transformPointsSoa(const point_soa_t *in, point_soa_t *out, double scale, point_t offset)
+{
+  if (!in || !out) return;
+  const size_t n = in->size < out->capacity ? in->size : out->capacity;
+  const Kernels &k = kernels();
+  k.scaleAddN(in->x, out->x, n, scale, offset.x);
+  k.scaleAddN(in->y, out->y, n, scale, offset.y);
+  k.scaleAddN(in->z, out->z, n, scale, offset.z);
+  out->size = n;
+}
+
+DLL_PUBLIC_API const char *simdLevel()
+{
+  return kernels().name;
+}
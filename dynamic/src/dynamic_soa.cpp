@@ -0,0 +1,229 @@
+// SoA(Structure of Arrays) 布局的 point_t/box_t 集合: 内存分配、扩容以及与 AoS 布局的互相转换
+// 变换内核(transformPointsSoa)在 dynamic_simd.cpp 中, 与 AoS 版本共用运行时选择的 SIMD 实现
+#include <dynamic/dynamic.h>
+
+#include <cstring>
+#include <new>
+
+namespace
+{
+constexpr size_t kAlignment = 64;                                // 缓存行大小, 也满足 AVX-512 的对齐要求
+constexpr size_t kDoublesPerLine = kAlignment / sizeof(double);  // 每个缓存行的 double 个数
+
+void *allocAligned(size_t bytes)
+{
+  return ::operator new(bytes, std::align_val_t(kAlignment), std::nothrow);
+}
+
+void freeAligned(void *p)
+{
+  ::operator delete(p, std::align_val_t(kAlignment));
+}
+
+// 元素个数向上取整到整缓存行, 使每个分量数组都从缓存行边界开始; 取整会溢出时返回 false
+bool roundCapacity(size_t capacity, size_t &stride)
+{
+  if (capacity > static_cast<size_t>(-1) - (kDoublesPerLine - 1)) return false;
+  stride = (capacity + kDoublesPerLine - 1) / kDoublesPerLine * kDoublesPerLine;
+  return true;
+}
+
+// 一次分配 x/y/z 三个分量数组(同一块内存), 失败返回 false
+bool allocPoints(point_soa_t &soa, size_t capacity)
+{
+  size_t stride;
+  if (!roundCapacity(capacity, stride)) return false;
+  if (stride > static_cast<size_t>(-1) / (3 * sizeof(double))) return false;  // 字节数溢出
+  double *block = static_cast<double *>(allocAligned(3 * stride * sizeof(double)));
+  if (!block) return false;
+  soa.x = block;
+  soa.y = block + stride;
+  soa.z = block + 2 * stride;
+  soa.size = 0;
+  soa.capacity = stride;
+  return true;
+}
+
+void copyPoints(const point_soa_t &src, point_soa_t &dst)
+{
+  const size_t bytes = src.size * sizeof(double);
+  if (bytes == 0) return;
+  std::memcpy(dst.x, src.x, bytes);
+  std::memcpy(dst.y, src.y, bytes);
+  std::memcpy(dst.z, src.z, bytes);
+}
+
+void releasePoints(point_soa_t &soa)
+{
+  freeAligned(soa.x);  // y/z 与 x 位于同一块内存
+  soa = point_soa_t();
+}
+}  // namespace
+
+DLL_PUBLIC_API int point_soa_init(point_soa_t *soa, size_t capacity)
+{
+  if (!soa) return -1;
+  *soa = point_soa_t();
+  return point_soa_reserve(soa, capacity);
+}
+
+DLL_PUBLIC_API int point_soa_reserve(point_soa_t *soa, size_t capacity)
+{
+  if (!soa) return -1;
+  if (capacity <= soa->capacity) return 0;
+  point_soa_t grown;
+  if (!allocPoints(grown, capacity)) return -1;
+  grown.size = soa->size;
+  copyPoints(*soa, grown);
+  releasePoints(*soa);
+  *soa = grown;
+  return 0;
+}
+
+DLL_PUBLIC_API void point_soa_free(point_soa_t *soa)
+{
+  if (soa) releasePoints(*soa);
+}
+
+DLL_PUBLIC_API size_t point_soa_from_aos(point_soa_t *dst, const point_t *src, size_t n)
+{
+  if (!dst || !src) return 0;
+  if (n > dst->capacity) n = dst->capacity;
+  for (size_t i = 0; i < n; ++i)
+  {
+    dst->x[i] = src[i].x;
+    dst->y[i] = src[i].y;
+    dst->z[i] = src[i].z;
+  }
+  dst->size = n;
+  return n;
+}
+
+DLL_PUBLIC_API size_t point_soa_to_aos(const point_soa_t *src, point_t *dst, size_t n)
+{
+  if (!src || !dst) return 0;
+  if (n > src->size) n = src->size;
+  for (size_t i = 0; i < n; ++i) dst[i] = point_t{src->x[i], src->y[i], src->z[i]};
+  return n;
+}
+
+DLL_PUBLIC_API int boundsPointsSoa(const point_soa_t *soa, point_t *min, point_t *max)
+{
+  if (!soa || soa->size == 0 || !min || !max) return -1;
+  // 每个分量单独遍历一个连续数组, 只读取坐标数据
+  const double *axes[3] = {soa->x, soa->y, soa->z};
+  double lo[3], hi[3];
+  for (int a = 0; a < 3; ++a)
+  {
+    const double *v = axes[a];
+    lo[a] = hi[a] = v[0];
+    for (size_t i = 1; i < soa->size; ++i)
+    {
+      lo[a] = v[i] < lo[a] ? v[i] : lo[a];
+      hi[a] = v[i] > hi[a] ? v[i] : hi[a];
+    }
+  }
+  *min = point_t{lo[0], lo[1], lo[2]};
+  *max = point_t{hi[0], hi[1], hi[2]};
+  return 0;
+}
+
+DLL_PUBLIC_API int box_soa_init(box_soa_t *soa, size_t capacity)
+{
+  if (!soa) return -1;
+  *soa = box_soa_t();
+  return box_soa_reserve(soa, capacity);
+}
+
+DLL_PUBLIC_API int box_soa_reserve(box_soa_t *soa, size_t capacity)
+{
+  if (!soa) return -1;
+  if (capacity <= soa->capacity) return 0;
+  // 先分配所有新数组, 任何一个失败都不修改 soa
+  point_soa_t min, max;
+  if (!allocPoints(min, capacity)) return -1;
+  if (!allocPoints(max, capacity))
+  {
+    releasePoints(min);
+    return -1;
+  }
+  const size_t stride = min.capacity;
+  if (stride > static_cast<size_t>(-1) / sizeof(*soa->name))  // 名称数组(最大的元素)的字节数溢出
+  {
+    releasePoints(min);
+    releasePoints(max);
+    return -1;
+  }
+  int *id = static_cast<int *>(allocAligned(stride * sizeof(int)));
+  char(*name)[64] = static_cast<char(*)[64]>(allocAligned(stride * sizeof(*name)));
+  if (!id || !name)
+  {
+    freeAligned(id);
+    freeAligned(name);
+    releasePoints(min);
+    releasePoints(max);
+    return -1;
+  }
+
+  const size_t size = soa->size;
+  if (size > 0)
+  {
+    std::memcpy(id, soa->id, size * sizeof(int));
+    std::memcpy(name, soa->name, size * sizeof(*name));
+  }
+  min.size = max.size = size;
+  copyPoints(soa->min, min);
+  copyPoints(soa->max, max);
+
+  box_soa_free(soa);
+  soa->id = id;
+  soa->name = name;
+  soa->min = min;
+  soa->max = max;
+  soa->size = size;
+  soa->capacity = stride;
+  return 0;
+}
+
+DLL_PUBLIC_API void box_soa_free(box_soa_t *soa)
+{
+  if (!soa) return;
+  freeAligned(soa->id);
+  freeAligned(soa->name);
+  releasePoints(soa->min);
+  releasePoints(soa->max);
+  *soa = box_soa_t();
+}
+
+DLL_PUBLIC_API size_t box_soa_from_aos(box_soa_t *dst, const box_t *src, size_t n)
+{
+  if (!dst || !src) return 0;
+  if (n > dst->capacity) n = dst->capacity;
+  for (size_t i = 0; i < n; ++i)
+  {
+    dst->id[i] = src[i].id;
+    std::memcpy(dst->name[i], src[i].name, sizeof(src[i].name));
+    dst->min.x[i] = src[i].min.x;
+    dst->min.y[i] = src[i].min.y;
+    dst->min.z[i] = src[i].min.z;
+    dst->max.x[i] = src[i].max.x;
+    dst->max.y[i] = src[i].max.y;
+    dst->max.z[i] = src[i].max.z;
+  }
+  dst->size = dst->min.size = dst->max.size = n;
+  return n;
+}
+
+DLL_PUBLIC_API size_t box_soa_to_aos(const box_soa_t *src, box_t *dst, size_t n)
+{
+  if (!src || !dst) return 0;
+  if (n > src->size) n = src->size;
+  for (size_t i = 0; i < n; ++i)
+  {
+    dst[i].id = src->id[i];
+    std::memcpy(dst[i].name, src->name[i], sizeof(dst[i].name));
+    dst[i].min = point_t{src->min.x[i], src->min.y[i], src->min.z[i]};
+    dst[i].max = point_t{src->max.x[i], src->max.y[i], src->max.z[i]};
+  }
+  return n;
+}